@@ -248,9 +248,6 @@ void __section("adcPulseSen") adcDataHandler(void)
     return;
 }
 
-static char realTimeIntervalLH[11], realTimeIntervalHL[11];
-static char realTimeVoltage[12];
-
 void __section("adcPulseSen") adc_task(void)
 {
     task_open();
@@ -276,19 +273,16 @@ void __section("adcPulseSen") adc_task(void)
             // Note: TX and RX will interlace. Printing here can 
             //       interlace printing in textTerm.c.
             //-------------------------------------------------------
-            u32_a12((uint32_t)U24GETVALUE(timeIntervalLH), (char*)realTimeIntervalLH);
             printa((char*) "Low to high edge time ");
-            printa((char*)realTimeIntervalLH);
+            printu((uint32_t)U24GETVALUE(timeIntervalLH), FMT_DEC, 0);
             printa((char*) "\n\0");
             task_wait(1);
-            u32_a12((uint32_t)U24GETVALUE(timeIntervalHL), (char*)realTimeIntervalHL);
             printa((char*) "High to low edge time ");
-            printa((char*)realTimeIntervalHL);
+            printu((uint32_t)U24GETVALUE(timeIntervalHL), FMT_DEC, 0);
             printa((char*) "\n\0");
             task_wait(1);
-            u32_a12((uint32_t)(adcValueLog), (char*)realTimeVoltage);
             printa((char*) "Pulse magnitude value ");
-            printa((char*)realTimeVoltage);
+            printu((uint32_t)(adcValueLog), FMT_DEC, 0);
             printa((char*) "\n\0");
             printa((char*) "\n\0");
         }
@@ -5,6 +5,7 @@
 // Created on February 25, 2020, 11:57 AM
 //-----------------------------------------------------------------------------
 
+#include "xc.h"
 #include "alarm.h"
 #include "cocoos.h"
 #include "edgeDetect.h"
@@ -13,6 +14,7 @@
 #include "audioVisual.h"
 #include "uintegers2.h"
 #include "i2a.h"
+#include "rtc.h"
 
 //-----------------------------------------------------------------------------
 // Parameters pAlarmLevel and mAlarmLevel
@@ -25,31 +27,95 @@ uint32_t pAlarmLevel = 0;
 uint32_t mAlarmLevel = 0;
 uint8_t sampleInterval = 50;
 static uint8_t samplingCount; // x10ms, max 2550 ms = 2.5 seconds
+uint8_t alarmState = ALARM_NONE;
+uint32_t alarmStamp;
 
-char __section("alarmAlg") *pAlarmHexString(void)
+//-----------------------------------------------------------------------------
+// mAlarmTrip24 is the 24-bit copy of mAlarmLevel read by TMR1_GATE_ISR(). It
+// is byte-addressable so that the ISR compare stays within 8/16-bit machine
+// operations. mAlarmTripped is set by the ISR when it has driven the trip 
+// output, and cleared by alarm_task() once the task layer has taken over.
+//-----------------------------------------------------------------------------
+volatile uinteger24_t mAlarmTrip24;
+volatile bool mAlarmTripped = false;
+
+#if AV_BUZZER_PITCH
+//-----------------------------------------------------------------------------
+// Buzzer pitch step n (1..AV_PITCH_STEPS-1) is reached when speed exceeds the
+// pre-alarm speed by n/16, i.e. pulse period < pAlarmLevel x 16/(16+n). The 
+// factors 16/(16+n) are kept in flash as Q8 fractions. pitchLevel[] is worked
+// out with multiply-and-shift when the parameter changes, sampling only does 
+// compares. Level is capped to 24 bits so that the product fits 32 bits. 
+//-----------------------------------------------------------------------------
+const uint8_t __section("alarmAlg") pitchQ8[AV_PITCH_STEPS - 1] = \
 {
-    static char s[12];
-    uinteger32_t x;
-    x.value = pAlarmLevel;
-    trimLeft(u32_to_hex(x, 3), s);
-    return s;
+    241, 228, 216, 205, 195, 186, 178
+};
+static uint32_t pitchLevel[AV_PITCH_STEPS - 1];
+
+static uint8_t __section("alarmAlg") pitchStep(uint32_t t)
+{
+    uint8_t n = 0;
+    while (n < (AV_PITCH_STEPS - 1) && t < pitchLevel[n]) {++n;}
+    return n;
 }
+#endif
 
-char __section("alarmAlg") *mAlarmHexString(void)
+//-----------------------------------------------------------------------------
+// alarmLevelUpdate() must be called after every change to pAlarmLevel or 
+// mAlarmLevel. When capture MSB is 0xFF the lower bytes are not valid (see 
+// getPulsePeriod24()), so the threshold is capped at 0x00FF0000 for the ISR
+// byte compare to never act on such a capture. 
+//-----------------------------------------------------------------------------
+void __section("alarmAlg") alarmLevelUpdate(void)
 {
-    static char s[12];
     uinteger32_t x;
     x.value = mAlarmLevel;
-    trimLeft(u32_to_hex(x, 3), s);
-    return s;
+    if (x.value > 0x00FEFFFF) {x.value = 0x00FF0000;}
+    //---------------------------------------------------------------
+    // TMR1 gate interrupt is off in "sparse edge mode", restore it to
+    // whatever it was. 
+    //---------------------------------------------------------------
+    uint8_t ie = PIE3bits.TMR1GIE;
+    PIE3bits.TMR1GIE = 0;
+    mAlarmTrip24.bytes.C0 = x.bytes.C0;
+    mAlarmTrip24.bytes.C1 = x.bytes.C1;
+    mAlarmTrip24.bytes.C2 = x.bytes.C2;
+    PIE3bits.TMR1GIE = ie;
+    
+#if AV_BUZZER_PITCH
+    x.value = (pAlarmLevel > 0x00FFFFFF) ? 0x00FFFFFF : pAlarmLevel;
+    for (uint8_t n = 0; n < (AV_PITCH_STEPS - 1); ++n)
+    {
+        pitchLevel[n] = (x.value * pitchQ8[n]) >> 8;
+    }
+#endif
+    return;
 }
 
-char __section("alarmAlg") *mIntervalDecString(void)
+//-----------------------------------------------------------------------------
+// alarmState is only written here, alarmStamp notes when it last changed. 
+//-----------------------------------------------------------------------------
+static void __section("alarmAlg") alarmSetState(uint8_t s)
 {
-    static char s[12];
-    trimLeft(u32_to_a11(sampleInterval), s);
-    return s;
+    if (s != alarmState) {alarmStamp = rtcStamp(); alarmState = s;}
+    return;
 }
+
+//-----------------------------------------------------------------------------
+// alarmAgeMs() : milli-seconds since alarmState last changed, reported by 
+// sysi. Stamps wrap after 35.8 minutes, so alarm_task() holds alarmStamp 
+// back to at most ALARM_AGE_MAX old: the age saturates at 30 minutes. 
+//-----------------------------------------------------------------------------
+#define ALARM_AGE_MAX ((uint32_t)1800 * RTC_STAMP_HZ)
+
+uint32_t __section("alarmAlg") alarmAgeMs(void)
+{
+    uint32_t d = rtcStamp() - alarmStamp;
+    if (d > ALARM_AGE_MAX) {d = ALARM_AGE_MAX;}
+    return d / (RTC_STAMP_HZ / 1000);
+}
+
 //-----------------------------------------------------------------------------
 // Begin coding with simple straight-forward alarm algorithm. DSP-like feature
 // such as moving average and odd value rejection are to be considered later. 
@@ -63,31 +129,58 @@ void __section("alarmAlg") alarm_task(void)
     samplingCount = 0; // initialize (sit between task_open() & for()
     avControl(LED_i_BLUE, AV_PSL);
     avControl(  BUZZER  , AV_OFF);
+    avControl(MALARM_TRIP_DEVICE, AV_OFF);
     //---------------------------------------------------------------
     for(;;) 
     {
-        task_wait(10);
+        task_wait_period(10);
         if(++samplingCount < sampleInterval) {continue;}
         samplingCount = 0;
+        if ((rtcStamp() - alarmStamp) > ALARM_AGE_MAX) 
+            {alarmStamp = rtcStamp() - ALARM_AGE_MAX;}
         uinteger32_t x;
         x.value = getPulsePeriod24();
+    #if AV_BUZZER_PITCH
+        if (x.value < pAlarmLevel) {avBuzzerPitch(pitchStep(x.value));}
+    #endif
         if (x.value < mAlarmLevel)
         {
             avControl(LED_i_BLUE, AV_FUL);
             avControl(  BUZZER  , AV_FUL);
+            avControl(MALARM_TRIP_DEVICE, AV_FUL);
+            alarmSetState(ALARM_MAIN);
+            mAlarmTripped = false; //-------- task layer has taken over
+            continue;
         }
-        else if (x.value < pAlarmLevel)
+        
+        if (x.value < pAlarmLevel)
         {
             avControl(LED_i_BLUE, AV_PSS);
             avControl(  BUZZER  , AV_PRP);
+            alarmSetState(ALARM_PRE);
         }
         else
         {
             avControl(LED_i_BLUE, (x.bytes.C3) ? AV_OFF : AV_PSL);
             avControl(  BUZZER  , AV_OFF);
+            alarmSetState(ALARM_NONE);
+        }
+        avControl(MALARM_TRIP_DEVICE, AV_OFF);
+        
+        //-----------------------------------------------------------
+        // Release: the ISR fast path may have set the output on while
+        // the AV state is still 'off'. av_control_task() does not see
+        // a state change in that case, re-assert it here. 
+        //-----------------------------------------------------------
+        if (mAlarmTripped)
+        {
+            mAlarmTripped = false;
+            avResync(MALARM_TRIP_DEVICE);
         }
     }
     task_close(); //--------- Control will never fall onto this point
 }
 
+#undef ALARM_AGE_MAX
+
 //----------------------------------------------------------------- end of file
@@ -10,15 +10,52 @@
 
 #include "stdint.h"
 #include "stdbool.h"
+#include "uintegers2.h"
+#include "audioVisual.h"
+
+//-----------------------------------------------------------------------------
+// Main alarm trip output. The task layer drives MALARM_TRIP_DEVICE on/off 
+// following the main alarm decision made at each sampling interval. 
+//-----------------------------------------------------------------------------
+// MALARM_FAST_TRIP 1 == in addition TMR1_GATE_ISR() compares every captured 
+// pulse period against mAlarmTrip24 and sets the trip output directly from 
+// the ISR (microseconds instead of up to sampleInterval + 25 ms). The ISR only
+// ever turns the output on. Release and AV patterns remain with alarm_task()
+// and av_control_task().                                             
+//-----------------------------------------------------------------------------
+#define MALARM_TRIP_DEVICE     RELAY             // RELAY or OC1
+#define MALARM_FAST_TRIP       (1)               // 0 == ISR fast path off
+
+// The device ids are numbers (audioVisual.h), so the pin setter cannot be
+// token-pasted from MALARM_TRIP_DEVICE; select it here instead. "On" is the
+// high level for both, as in av_control_task().
+#if   (MALARM_TRIP_DEVICE == RELAY)
+#define MALARM_FAST_TRIP_SET() RELAY_SetHigh()
+#elif (MALARM_TRIP_DEVICE == OC1)
+#define MALARM_FAST_TRIP_SET() OC1_SetHigh()
+#else
+#error "MALARM_TRIP_DEVICE must be RELAY or OC1"
+#endif
+
+//-----------------------------------------------------------------------------
+// alarmState as last decided by alarm_task(), alarmStamp its rtcStamp() at
+// the last transition, alarmAgeMs() the time since, saturating at 30 minutes
+//-----------------------------------------------------------------------------
+#define ALARM_NONE (0)
+#define ALARM_PRE  (1)
+#define ALARM_MAIN (2)
 
 void alarm_task(void);
+void alarmLevelUpdate(void); // after every change to pAlarmLevel/mAlarmLevel
+uint32_t alarmAgeMs(void);
 
 extern uint32_t pAlarmLevel;
 extern uint32_t mAlarmLevel;
 extern uint8_t sampleInterval;
-char *pAlarmHexString(void);
-char *mAlarmHexString(void);
-char *mIntervalDecString(void);
+extern uint8_t alarmState;
+extern uint32_t alarmStamp;
+extern volatile uinteger24_t mAlarmTrip24;
+extern volatile bool mAlarmTripped;
 
 #endif	/* ALARM_H */
 
@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------------
+// File:   analogOut.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Frequency f = 16 MHz / t where t is the pulse period in TMR1 ticks. With 
+// D = aoutFullHz - aoutZeroHz the duty is
+//     duty = (f - aoutZeroHz) x 1023 / D  =  K / t - Z
+//     K = 16e6 x 1023 / D,   Z = aoutZeroHz x 1023 / D
+// K and Z are worked out by aoutSetScale() when the scale changes. Per 
+// capture the ISR is left with 1/t, which is looked up: t is normalized to an
+// 8-bit mantissa m (128..255) and exponent s, and recipSeed[] holds 2^23/m. 
+// K is kept as 16-bit mantissa kM and exponent kE. Hence
+//     K / t = kM x recipSeed[m - 128] >> (23 + s - kE)
+// a 16 x 16 bit multiply and shifts, no division. Mantissa quantization is 
+// within +/-0.4% (table entries are taken at m + 0.5). 
+//-----------------------------------------------------------------------------
+
+#include "xc.h"
+#include "analogOut.h"
+#include "tmr2.h"
+#include "epwm2.h"
+#include "uintegers2.h"
+#include "i2a.h"
+#include "recip.h"
+#include "oscCal.h"
+
+//-----------------------------------------------------------------------------
+// 16e6 x 1023 does not fit 32 bits, it is divided by 4 here and the factor
+// put back as the initial exponent. The TMR1 tick rate is corrected by 
+// oscPpm (oscCal.h), AOUT_K_NUM / 1e6 per ppm, 4.22e9 at +3%. 
+//-----------------------------------------------------------------------------
+#define AOUT_K_NUM (4092000000UL)
+#define AOUT_K_EXP (2)
+
+uint16_t aoutZeroHz = 0;
+uint16_t aoutFullHz = 0;
+
+//-----------------------------------------------------------------------------
+// Read by the capture ISRs. aoutSetScale() updates them with TMR1 gate and 
+// CMP1 interrupts suspended. 
+//-----------------------------------------------------------------------------
+static uint16_t kM, kZ;
+static uint8_t kE;
+static bool aoutValid = false;
+
+//-----------------------------------------------------------------------------
+// TMR2/EPWM2 are left as MCC configured them (buzzer) unless AOUT_ENABLE. 
+//-----------------------------------------------------------------------------
+void aoutInitialize(void)
+{
+#if AOUT_ENABLE
+    TMR2_StopTimer();
+    T2CON = 0x00;                   // 1:1 prescale, 1:1 postscale, off
+    TMR2_LoadPeriodRegister(0xFF);  // 62.5 kHz
+    AOUT_LOAD(0);
+    TMR2_StartTimer();
+#endif
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// aoutFullHz <= aoutZeroHz is not a valid scale, the output then stays at 0.
+//-----------------------------------------------------------------------------
+void __section("analogOut") aoutSetScale(uint16_t zeroHz, uint16_t fullHz)
+{
+    uinteger32_t k;
+    uint8_t e = AOUT_K_EXP;
+    uint16_t z = 0;
+    bool valid = false;
+    
+    aoutZeroHz = zeroHz;
+    aoutFullHz = fullHz;
+    k.value = 0;
+    if (fullHz > zeroHz)
+    {
+        uint16_t d = fullHz - zeroHz;
+        uint32_t zz = (uint32_t)zeroHz * AOUT_DUTY_MAX / d;
+        k.value = (AOUT_K_NUM + (int32_t)oscPpm * (int32_t)(AOUT_K_NUM / 1000000UL)) / d;
+        while (k.words.W1) {k.value >>= 1; ++e;}
+        z = (zz > UINT16_MAX) ? UINT16_MAX : (uint16_t)zz;
+        valid = true;
+    }
+    
+    uint8_t ie1 = PIE3bits.TMR1GIE;
+    uint8_t ie2 = PIE2bits.C1IE;
+    PIE3bits.TMR1GIE = 0;
+    PIE2bits.C1IE = 0;
+    kM = k.words.W0;
+    kE = e;
+    kZ = z;
+    aoutValid = valid;
+    PIE2bits.C1IE = ie2;
+    PIE3bits.TMR1GIE = ie1;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Called by TMR1_GATE_ISR() and CMP1_ISR() with the new pulse period t in 
+// TMR1 ticks (1/16 us). t == 0 gives 0 output. 
+//-----------------------------------------------------------------------------
+void __section("analogOut") aoutPeriod(uint32_t t)
+{
+    uinteger32_t x;
+    uint16_t d = 0;
+    x.value = t;
+    if (aoutValid && x.value)
+    {
+        //-----------------------------------------------------------
+        // Normalize: byte steps first, then bit steps, to 1xxxxxxxb
+        //-----------------------------------------------------------
+        int8_t sh = 23 - (int8_t)kE;
+        while (x.words.W1) {x.value >>= 8; sh += 8;}
+        while (x.bytes.C1) {x.value >>= 1; ++sh;}
+        while (!(x.bytes.C0 & 0x80)) {x.bytes.C0 <<= 1; --sh;}
+        
+        if (sh <= 0) {d = AOUT_DUTY_MAX;}
+        else
+        {
+            x.value = (uint32_t)kM * recipSeed[x.bytes.C0 - 128];
+            if (sh < 32) {x.value >>= sh;} else {x.value = 0;}
+            if (x.value > kZ)
+            {
+                x.value -= kZ;
+                d = (x.value > AOUT_DUTY_MAX) ? AOUT_DUTY_MAX : x.words.W0;
+            }
+        }
+    }
+    AOUT_LOAD(d);
+    return;
+}
+
+#undef AOUT_K_EXP
+#undef AOUT_K_NUM
+
+//----------------------------------------------------------------- end of file
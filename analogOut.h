@@ -0,0 +1,46 @@
+//-----------------------------------------------------------------------------
+// File:   analogOut.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Analog speed output. EPWM2 duty is made proportional to the measured pulse
+// frequency. After an external RC filter this gives 0..5 V for legacy analog
+// gauges and data loggers. 
+//-----------------------------------------------------------------------------
+
+#ifndef ANALOGOUT_H
+#define	ANALOGOUT_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+//-----------------------------------------------------------------------------
+// AOUT_ENABLE 1 == EPWM2 is the analog output. TMR2 is re-configured to 1:1
+// prescale and PR2 = 255 (62.5 kHz, 10-bit duty) and runs continuously. The
+// buzzer is then not available to audioVisual. 0 == EPWM2 drives the buzzer.
+//-----------------------------------------------------------------------------
+// aoutZeroHz maps to 0% duty (0 V), aoutFullHz to 100% duty (5 V). Values in 
+// between are linear in frequency, outside are clamped. Duty is updated from
+// the capture ISRs, i.e. on every new measurement. 
+//-----------------------------------------------------------------------------
+#define AOUT_ENABLE   (0)
+#define AOUT_DUTY_MAX (1023)
+
+//-----------------------------------------------------------------------------
+// Same register writes as EPWM2_LoadDutyValue(), expanded in place so that 
+// ISR and task code do not share a function. 
+//-----------------------------------------------------------------------------
+#define AOUT_LOAD(d) {CCPR2L = (uint8_t)((d) >> 2); \
+    CCP2CON = (uint8_t)((CCP2CON & 0xCF) | (((uint8_t)(d) & 0x03) << 4));}
+
+extern uint16_t aoutZeroHz;
+extern uint16_t aoutFullHz;
+
+void aoutInitialize(void);
+void aoutSetScale(uint16_t zeroHz, uint16_t fullHz);
+void aoutPeriod(uint32_t t);
+
+#endif	/* ANALOGOUT_H */
+
+//----------------------------------------------------------------- end of file
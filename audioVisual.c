@@ -10,50 +10,165 @@
 #include "pin_manager.h"
 #include "cocoos.h"
 #include "stdbool.h"
-#include "pin_manager.h"
+#include "stddef.h"
 #include "tmr2.h"
+#include "epwm2.h"
+#include "edgeDetect.h"
+#include "analogOut.h"
+#include "rtc.h"
+
+#if AOUT_ENABLE && AV_BUZZER_PITCH
+#error "EPWM2 is either the analog output or the buzzer, not both"
+#endif
 
 static avControlStruct_t avc[AV_MAX], *p;
 #define ONETENTHSECOND (4)
 
+//-----------------------------------------------------------------------------
+// avEvent wakes av_control_task() when a device has been given a new mode. 
+// Otherwise the task sleeps until the nearest scheduled transition. 
+//-----------------------------------------------------------------------------
+Evt_t avEvent;
+
+//-----------------------------------------------------------------------------
+// Flash-resident sequences, see AV_S_xxx step encoding in audioVisual.h. 
+//-----------------------------------------------------------------------------
+const uint8_t __section("AV") avSeqOFF[] = {AV_S_HOLD_OFF};
+const uint8_t __section("AV") avSeqFUL[] = {AV_S_HOLD_ON};
+const uint8_t __section("AV") avSeqPSL[] = \
+{
+    AV_S_ON((uint8_t)(0.25*ONETENTHSECOND)), 
+    AV_S_OFF((uint8_t)(19.75*ONETENTHSECOND)), 
+    AV_S_LOOP
+};
+const uint8_t __section("AV") avSeqPSS[] = \
+{
+    AV_S_ON(5*ONETENTHSECOND), AV_S_OFF(5*ONETENTHSECOND), AV_S_LOOP
+};
+const uint8_t __section("AV") avSeqPRP[] = \
+{
+    AV_S_ON((uint8_t)(2.5*ONETENTHSECOND)), 
+    AV_S_OFF((uint8_t)(2.5*ONETENTHSECOND)), 
+    AV_S_LOOP
+};
+const uint8_t __section("AV") avSeqBP2[] = \
+{
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(10*ONETENTHSECOND), 
+    AV_S_LOOP
+};
+const uint8_t __section("AV") avSeqBP3[] = \
+{
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(10*ONETENTHSECOND), 
+    AV_S_LOOP
+};
+//-----------------------------------------------------------------------------
+// Morse timing: dot 100 ms, dash and letter gap 3 dots, word gap 7 dots
+//-----------------------------------------------------------------------------
+const uint8_t __section("AV") avSeqSOS[] = \
+{
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(3*ONETENTHSECOND), 
+    AV_S_ON(3*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(3*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(3*ONETENTHSECOND), AV_S_OFF(3*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(7*ONETENTHSECOND), 
+    AV_S_LOOP
+};
+//-----------------------------------------------------------------------------
+// Escalating: 2x slow, 3x medium, 4x fast, then continuously on. Played once,
+// the final step holds until the mode is changed. 
+//-----------------------------------------------------------------------------
+const uint8_t __section("AV") avSeqESC[] = \
+{
+    AV_S_ON(2*ONETENTHSECOND), AV_S_OFF(2*ONETENTHSECOND), 
+    AV_S_ON(2*ONETENTHSECOND), AV_S_OFF(2*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(1*ONETENTHSECOND), AV_S_OFF(1*ONETENTHSECOND), 
+    AV_S_ON(2), AV_S_OFF(2), AV_S_ON(2), AV_S_OFF(2), 
+    AV_S_ON(2), AV_S_OFF(2), AV_S_ON(2), AV_S_OFF(2), 
+    AV_S_HOLD_ON
+};
+
+//-----------------------------------------------------------------------------
+// Mode number to sequence look-up, indexed by AV_OFF..AV_ESC
+//-----------------------------------------------------------------------------
+const uint8_t * const __section("AV") avSeq[AV_MODE_MAX] = \
+{
+    avSeqOFF, avSeqPSL, avSeqPSS, avSeqPRP, avSeqFUL, 
+    avSeqBP2, avSeqBP3, avSeqSOS, avSeqESC
+};
+
+#if AV_BUZZER_PITCH
+//-----------------------------------------------------------------------------
+// TMR2 is clocked at 1 MHz (FOSC/4, 1:16 prescale), tone = 1 MHz / (PR2 + 1)
+// Steps are roughly 6% apart: 4.00, 4.24, 4.50, 4.81, 5.13, 5.49, 5.88 and
+// 6.33 kHz. The lowest tone TMR2 can make at this prescale is 3.9 kHz (PR2 =
+// 255), hence the tone only ever goes up from the 4 kHz default. 
+//-----------------------------------------------------------------------------
+const uint8_t __section("AV") avPitchPR2[AV_PITCH_STEPS] = \
+{
+    249, 235, 221, 207, 194, 181, 169, 157
+};
+static uint8_t avPitch = 0;            // step 0 == MCC initial PR2 and duty
+static bool avPitchPending = false;
+
+//-----------------------------------------------------------------------------
+// 50% duty: 10-bit duty value against a period of 4 x (PR2 + 1). CCPR2L is 
+// double-buffered by hardware, PR2 is not. If TMR2 happens to be past the new
+// PR2 value one period is stretched to 256 us, which is not audible. 
+//-----------------------------------------------------------------------------
+static void avPitchLoad(void)
+{
+    uint8_t pr = avPitchPR2[avPitch];
+    TMR2_LoadPeriodRegister(pr);
+    EPWM2_LoadDutyValue(((uint16_t)pr + 1) << 1);
+    avPitchPending = false;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Select buzzer pitch step. Repeating the current step costs a compare. While
+// the buzzer is silent (TMR2 stopped) the change is only recorded, and loaded
+// by switchState() when the buzzer is next turned on. 
+//-----------------------------------------------------------------------------
+void __section("AV") avBuzzerPitch(uint8_t step)
+{
+    if (step >= AV_PITCH_STEPS) {step = AV_PITCH_STEPS - 1;}
+    if (step == avPitch) {return;}
+    avPitch = step;
+    if (T2CONbits.TMR2ON) {avPitchLoad();} else {avPitchPending = true;}
+    return;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // Configure the designated AV device to one of the standard output mode.
 // Function return value:
 //     true  == success
 //     false == failed
-// t0, t1 scales to clock tick rate implemented in the control code module. 
-// Propose 25 ms, x4 = 100 ms. 
+// Re-applying the mode a device is already in is a no-op so that callers may
+// assert the mode periodically without restarting the sequence. The change is
+// picked up by av_control_task() which is woken through avEvent. 
 //-----------------------------------------------------------------------------
 bool __section("AV") avControl(uint8_t item, uint8_t mode)
 {
-    if (item >= AV_MAX) {return false;}
+    if (item >= AV_MAX || mode >= AV_MODE_MAX) {return false;}
     avControlStruct_t *c = &avc[item];
-    switch(mode)
-    {
-        case AV_OFF: 
-            c->t0 = 0;
-            c->t1 = 1;
-            break;
-        case AV_PSL:
-            c->t0 = (uint8_t)( 0.25 * ONETENTHSECOND);
-            c->t1 = (uint8_t)(19.75 * ONETENTHSECOND);  
-            break;
-        case AV_PSS:
-            c->t0 = (uint8_t)(5 * ONETENTHSECOND);
-            c->t1 = (uint8_t)(5 * ONETENTHSECOND);  
-            break;
-        case AV_PRP:
-            c->t0 = (uint8_t)(2.5 * ONETENTHSECOND);
-            c->t1 = (uint8_t)(2.5 * ONETENTHSECOND);
-            break;
-        case AV_FUL:
-            c->t0 = 1;
-            c->t1 = 0;            
-            break;
-        default:
-            return false;
-            break;
-    }
+    if (c->mode == mode) {return true;}
+    c->mode = mode;
+    c->pattern = avSeq[mode];
+    c->cursor = NULL;
+    //---------------------------------------------------------------
+    // Non-scheduling signal: this is a plain function, not a task
+    //---------------------------------------------------------------
+    event_ISR_signal(avEvent);
     return true;
 }
 
@@ -78,13 +193,24 @@ static void switchState(uint8_t device)
             if (!p->onOff) {LED_BLUE_SetHigh();} else {LED_BLUE_SetLow();}
             break;
         case BUZZER:
-            if (!p->onOff) {TMR2_StopTimer();  } else {TMR2_StartTimer();}
+        #if AOUT_ENABLE //---- else EPWM2/TMR2 are owned by analog output
+            break;
+        #endif
+            if (!p->onOff) {TMR2_StopTimer();  } else 
+            {
+            #if AV_BUZZER_PITCH
+                if (avPitchPending) {avPitchLoad();}
+            #endif
+                TMR2_StartTimer();
+            }
             break;
         case RELAY:
             if (!p->onOff) {RELAY_SetLow();    } else {RELAY_SetHigh();  }
             break;
         case OC1:
+        #if !OC1_REPEATER //------- else OC1 is owned by the pulse repeater
             if (!p->onOff) {OC1_SetLow(); /*-*/} else {OC1_SetHigh();/**/}
+        #endif
             break;
         default:
             break; //-------------------------------------- no action
@@ -92,12 +218,49 @@ static void switchState(uint8_t device)
     return;
 }
 
+//-----------------------------------------------------------------------------
+// Advance device (pre-loaded in p) to its next sequence step and schedule the
+// step after that. On (re)start the output is always re-asserted. 
+//-----------------------------------------------------------------------------
+static void avStep(uint8_t device)
+{
+    bool restart = (p->cursor == NULL);
+    if (restart) {p->cursor = p->pattern;}
+    uint8_t s = *p->cursor;
+    if (s == AV_S_LOOP) {p->cursor = p->pattern; s = *p->cursor;}
+    bool on = (s & 0x80) ? true : false;
+    s &= 0x7F;
+    if (s) {++p->cursor;} //--------- a hold step keeps the cursor put
+    p->remain = (uint16_t)s * AV_TICK_MS;
+    if (restart || on != p->onOff) {p->onOff = on; switchState(device);}
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Re-apply the current AV state of the device to its output. Used when code
+// outside of this module (e.g. an ISR fast path) has driven the output pin 
+// directly and the task layer needs to take it back. 
+//-----------------------------------------------------------------------------
+void __section("AV") avResync(uint8_t item)
+{
+    if (item >= AV_MAX) {return;}
+    p = &avc[item];
+    switchState(item);
+    return;
+}
+
 //-----------------------------------------------------------------------------
 // Task that centrally controls every attached available audio-visual device.
-// Base tick rate is set by task_wait() in the infinite for-loop.
+// Event-scheduled: the task sleeps until the nearest step transition of any
+// device, or until avEvent reports a mode change, whichever comes first. 
+// Devices holding a steady level cost nothing while the task sleeps. Time
+// elapsed is read from rtcMillis() so that steps do not stretch by the time
+// the task takes to run and to be scheduled. 
 //-----------------------------------------------------------------------------
 void __section("AV") av_control_task(void)
 {
+    static uint16_t wait, elapsed;
+    static uint32_t last;
     task_open();
     
     //---------------------------------------------------------------
@@ -106,41 +269,50 @@ void __section("AV") av_control_task(void)
     for (uint8_t i = 0; i < AV_MAX; ++i)
     {
         p = &avc[i];
-        p->count = p->t0 = p->t1 = 0;
+        p->mode = AV_OFF;
+        p->pattern = avSeq[AV_OFF];
+        p->cursor = NULL;
+        p->remain = 0;
         p->onOff = false;
-        switchState(i); //------------------------- set initial state
     }
     //---------------------------------------------------------------
     // System health indicator uses the in-circuit red LED
     //---------------------------------------------------------------
     avControl(LED_i_RED , AV_PSS);
+    elapsed = 0;
+    last = rtcMillis();
 
     //---------------------------------------------------------------
     // Task indefinite for(;;) with no termination condition
     //---------------------------------------------------------------
     for(;;) 
     {
-        //-----------------------------------------------------------
-        // Pace at 25 OS ticks each 1 ms. Total 25 ms. 
-        //-----------------------------------------------------------
-        task_wait( 25 );
-        
+        wait = 0;
         for (uint8_t i = 0; i < AV_MAX; ++i)
         {
             p = &avc[i];
-            
-            uint8_t j = p->count + 1;
-            if(!p->onOff)
+            if (p->cursor == NULL) 
             {
-                if (p->t0 && (!p->t1 || (j > p->t1))) 
-                    {j = 0; p->onOff = true; switchState(i);}
+                avStep(i); //------------------- new mode, (re)start
             }
-            else
+            else if (p->remain)
             {
-                if (p->t1 && (!p->t0 || (j > p->t0))) 
-                    {j = 0; p->onOff = false; switchState(i);}
+                if (p->remain > elapsed) {p->remain -= elapsed;}
+                else {avStep(i);}
             }
-            p->count = j;
+            if (p->remain && (!wait || p->remain < wait)) {wait = p->remain;}
+        }
+        
+        //-----------------------------------------------------------
+        // wait == 0 : every device is holding, sleep until avEvent. 
+        // Woken by the timeout or by avEvent, elapsed is the time
+        // since the last pass, whatever the task was held up by. 
+        //-----------------------------------------------------------
+        event_wait_timeout(avEvent, wait);
+        {
+            uint32_t now = rtcMillis();
+            elapsed = wait ? (uint16_t)(now - last) : 0;
+            last = now;
         }
     }
     task_close(); //--------- control will never fall onto this point
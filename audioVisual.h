@@ -10,19 +10,47 @@
 
 #include "stdint.h"
 #include "stdbool.h"
+#include "cocoos.h"
 
 void av_control_task(void);
 
 //-----------------------------------------------------------------------------
 // To simplify implementation concerning outputs such as LED, contacts and 
-// buzzer, 4 types of pre-defined behaviors are put in place. 
+// buzzer, pre-defined behaviors are put in place. Each mode is a flash-
+// resident run-length sequence played by av_control_task(). 
 //-----------------------------------------------------------------------------
 #define AV_OFF      (0)  // Not turned on
 #define AV_PSL      (1)  // Slow, short, periodic pulsation
 #define AV_PSS      (2)  // Slow but even M-S periodic pulsation
 #define AV_PRP      (3)  // Rapid, periodic pulsation
 #define AV_FUL      (4)  // Active continously
-#define AV_MODE_MAX (5)
+#define AV_BP2      (5)  // Double beep code, repeated
+#define AV_BP3      (6)  // Triple beep code, repeated
+#define AV_SOS      (7)  // Morse ... --- ... repeated
+#define AV_ESC      (8)  // Escalating cadence ending in continuous
+#define AV_MODE_MAX (9)
+
+//-----------------------------------------------------------------------------
+// Sequence step encoding, one byte per step. Duration t is in AV_TICK_MS 
+// units, 1..126. A step of duration 0 holds its level indefinitely (no 
+// further transition is scheduled). AV_S_LOOP restarts the sequence from its
+// first step and must not be the first step.
+//-----------------------------------------------------------------------------
+#define AV_TICK_MS     (25)
+#define AV_S_ON(t)     ((uint8_t)(0x80|(t)))
+#define AV_S_OFF(t)    ((uint8_t)(t))
+#define AV_S_HOLD_ON   AV_S_ON(0)
+#define AV_S_HOLD_OFF  AV_S_OFF(0)
+#define AV_S_LOOP      (0x7F)
+
+//-----------------------------------------------------------------------------
+// AV_BUZZER_PITCH 1 == buzzer tone follows speed. alarm_task() picks one of
+// AV_PITCH_STEPS steps at each sampling interval, step 0 being the default 
+// 4 kHz tone. TMR2 period and EPWM2 duty are only written when the step 
+// changes. 0 == fixed 4 kHz tone as configured by MCC. 
+//-----------------------------------------------------------------------------
+#define AV_BUZZER_PITCH (1)
+#define AV_PITCH_STEPS  (8)
 
 //-----------------------------------------------------------------------------
 // In the application as of on 25Feb2020, the following outputs and output
@@ -51,14 +79,20 @@ void av_control_task(void);
 //-----------------------------------------------------------------------------
 typedef struct avControlStruct
 {
-    uint8_t t0; // 0..254  'ON' time. 0 == full off (t1 non-zero)
-    uint8_t t1; // 0..254 'OFF' time. 0 == full on  (t0 non-zero)
-    uint8_t count;
+    const uint8_t *pattern; // first step of the sequence being played
+    const uint8_t *cursor;  // next step. NULL == (re)start the sequence
+    uint16_t remain;        // ms until the next step. 0 == holding
+    uint8_t mode;
     bool onOff;
 }
 avControlStruct_t;
 
+extern Evt_t avEvent;
 bool avControl(uint8_t item, uint8_t mode);
+void avResync(uint8_t item);
+#if AV_BUZZER_PITCH
+void avBuzzerPitch(uint8_t step);
+#endif
 
 #endif	/* AUDIOVISUAL_H */
 
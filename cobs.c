@@ -0,0 +1,49 @@
+//-----------------------------------------------------------------------------
+// File:   cobs.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+
+#include "cobs.h"
+
+//-----------------------------------------------------------------------------
+// cobsEncode()
+// Each zero byte is replaced by the distance to the next zero, the first byte
+// holds the distance to the first zero. n < 254, thus no 0xFF block handling.
+// Input:  in[n], out[] room for n+2 bytes
+// Output: the number of bytes written to out, the 0x00 delimiter included
+//-----------------------------------------------------------------------------
+uint8_t __section("cobs") cobsEncode(const uint8_t *in, uint8_t n, uint8_t *out)
+{
+    uint8_t code = 1, c = 0, o = 1;
+    for (uint8_t i = 0; i < n; ++i)
+    {
+        if (in[i]) {out[o++] = in[i]; ++code;}
+        else {out[c] = code; c = o++; code = 1;}
+    }
+    out[c] = code;
+    out[o++] = 0;
+    return o;
+}
+
+//-----------------------------------------------------------------------------
+// cobsDecode()
+// Input:  in[n], one encoded frame without its 0x00 delimiter. out may be the
+//         same buffer as in, decoding never overtakes the input. 
+// Output: the number of bytes written to out, 0 == malformed frame
+//-----------------------------------------------------------------------------
+uint8_t __section("cobs") cobsDecode(const uint8_t *in, uint8_t n, uint8_t *out)
+{
+    uint8_t i = 0, o = 0;
+    while (i < n)
+    {
+        uint8_t code = in[i++];
+        if ((code == 0) || (code - 1 > n - i)) {return 0;}
+        while (--code) {out[o++] = in[i++];}
+        if (i < n) {out[o++] = 0;}
+    }
+    return o;
+}
+
+//----------------------------------------------------------------- end of file
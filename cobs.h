@@ -0,0 +1,22 @@
+//-----------------------------------------------------------------------------
+// File:   cobs.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Consistent Overhead Byte Stuffing. An encoded frame contains no 0x00, which
+// is then free to be used as the frame delimiter. Frames are shorter than 254
+// bytes on this device, the encoding adds one byte plus the delimiter. 
+//-----------------------------------------------------------------------------
+
+#ifndef COBS_H
+#define	COBS_H
+
+#include "stdint.h"
+
+uint8_t cobsEncode(const uint8_t *in, uint8_t n, uint8_t *out);
+uint8_t cobsDecode(const uint8_t *in, uint8_t n, uint8_t *out);
+
+#endif	/* COBS_H */
+
+//----------------------------------------------------------------- end of file
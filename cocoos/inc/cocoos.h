@@ -89,12 +89,25 @@ extern "C" {
 						   	   } while ( 0 )
 
 
+#define OS_WAIT_UNTIL(x)	do {\
+								os_task_wait_until_set( running_tid, x );\
+								OS_SCHEDULE(0);\
+						   	   } while ( 0 )
+
+
+#define OS_WAIT_PERIOD(x)	do {\
+								os_task_wait_period_set( running_tid, x );\
+								OS_SCHEDULE(0);\
+						   	   } while ( 0 )
+
+
 
 extern uint8_t running_tid;
 extern uint8_t last_running_task;
 extern uint8_t running;
 
 uint8_t os_running( void );
+uint32_t os_tick_applied( void );
 
 
 #ifdef UNIT_TEST
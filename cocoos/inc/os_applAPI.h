@@ -137,6 +137,60 @@ static void myTask(void) {
 #define task_wait_id(id,x)                OS_WAIT_TICKS(x,id)
 
 
+/*********************************************************************************/
+/*  task_wait_until(x)                                                 *//**
+*   
+*   Macro for suspending a task until the main clock tick count, as returned by
+*   os_tick_get(), reaches x. If x has already been reached the task only yields.
+*   x also becomes the deadline that task_wait_period() counts from.
+*
+*   @param x Main clock tick count to wait for, 32 bit value.
+*   @remarks \b Usage: @n
+* @code 
+
+
+static void myTask(void) {
+ static uint32_t due;
+ task_open();	
+ due = os_tick_get();
+  ...
+  due += 100;
+  task_wait_until( due );
+  ...
+ task_close();
+}
+ @endcode 
+ *******************************************************************************/
+#define task_wait_until(x)                OS_WAIT_UNTIL(x)
+
+
+/*********************************************************************************/
+/*  task_wait_period(x)                                                 *//**
+*   
+*   Macro for periodic tasks. Suspends the task until x main clock ticks after its
+*   previous deadline, which then becomes the deadline. Unlike task_wait(), the period
+*   does not stretch by the time the task spends running or waiting to be scheduled.
+*   A task that falls behind runs without waiting until it has caught up. The first
+*   period starts at os_init(), or at the last task_wait_until().
+*
+*   @param x Period in main clock ticks, 32 bit value.
+*   @remarks \b Usage: @n
+* @code 
+
+
+static void myTask(void) {
+ task_open();	
+ for (;;) {
+  task_wait_period( 10 );
+  ...
+ }
+ task_close();
+}
+ @endcode 
+ *******************************************************************************/
+#define task_wait_period(x)                OS_WAIT_PERIOD(x)
+
+
 /*********************************************************************************/
 /*  task_suspend( id )                                                 *//**
 *   
@@ -410,6 +464,26 @@ ISR (SIG_UART_RECV) {
 #define event_ISR_signal(event) OS_INT_SIGNAL_EVENT(event)
 
 
+#if (OS_DEFERRED_TICK)
+extern volatile uint8_t os_tick_count;
+
+/*********************************************************************************/
+/*  os_tick_ISR()                                                 *//**
+*   
+*   Macro for the main clock tick, expanded in place in the clock tick ISR
+*
+*   @remarks \b Usage: @n Same as os_tick(), without the function call. Only available
+*   with OS_DEFERRED_TICK.
+* @code 
+ISR(SIG_OVERFLOW0) {
+    os_tick_ISR();
+}
+ @endcode 
+ *******************************************************************************/
+#define os_tick_ISR() do { ++os_tick_count; } while(0)
+#endif
+
+
 /*********************************************************************************/
 /*  sem_wait(sem)                                                 *//**
 *   
@@ -879,6 +953,7 @@ static void task2(void) {
 void os_init( void );
 void os_start( void );
 void os_tick( void );
+uint32_t os_tick_get( void );
 void os_sub_tick( uint8_t id );
 void os_sub_nTick( uint8_t id, uint32_t nTicks );
 uint8_t os_get_running_tid(void);
@@ -72,7 +72,7 @@ extern "C" {
 /** Max number of used events
 * @remarks Must be defined. @n Allowed range: 0-254. Value must not be exceeded */
 #ifndef N_EVENTS
- #define N_EVENTS            2
+ #define N_EVENTS            1
 #endif
 
 
@@ -82,6 +82,35 @@ extern "C" {
  #define ROUND_ROBIN         1
 #endif
 
+
+/** Ready bitmap
+* @remarks If 1, ready tasks are also kept in a bitmap and the scheduler finds the next task
+* in constant time, instead of scanning all tasks on every decision. Works with and without
+* ROUND_ROBIN. @n Allowed range of N_TASKS: 0-64 */
+#ifndef OS_READY_BITMAP
+ #define OS_READY_BITMAP     1
+#endif
+
+
+/** Deferred tick
+* @remarks If 1, os_tick() only counts the tick, and the task timers are advanced by the
+* scheduler loop before each scheduling decision. The work is moved out of the clock tick
+* ISR. The scheduler loop must come around at least once per 255 ticks, otherwise ticks
+* are lost. */
+#ifndef OS_DEFERRED_TICK
+ #define OS_DEFERRED_TICK    1
+#endif
+
+
+/** Timer list
+* @remarks If 1, tasks waiting on the main clock (task_wait() and event waits with timeout) are
+* kept in a list sorted by wake-up time, each holding the ticks after the one before it. A
+* tick then only updates the head of the list. Requires OS_DEFERRED_TICK. Events that wake
+* a task waiting with timeout must then be signaled from task code, not from an ISR. */
+#ifndef OS_TIMER_LIST
+ #define OS_TIMER_LIST       1
+#endif
+
     
 /** Memory size
  * @remarks Should be set to the size of address pointer */
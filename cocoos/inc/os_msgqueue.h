@@ -142,7 +142,7 @@ MsgQ_t os_msgQ_create( Msg_t *buffer, uint8_t nMessages, uint16_t msgSize,  uint
 MsgQ_t os_msgQ_find( uint8_t task_id );
 //Sem_t os_msgQ_sem_get( MsgQ_t queue );
 Evt_t os_msgQ_event_get( MsgQ_t queue );
-void os_msgQ_tick( MsgQ_t queue );
+void os_msgQ_tick( MsgQ_t queue, uint32_t nTicks );
 
 uint8_t os_msg_post( Msg_t *msg, MsgQ_t queue, uint32_t delay, uint32_t period );
 uint8_t os_msg_receive( Msg_t *msg, MsgQ_t queue );
@@ -33,11 +33,18 @@
  * Author: Peter Eckstrand <info@cocoos.net>
  */
  
-#include "xc.h"
-
 #ifndef OS_PORT_H_
 #define OS_PORT_H_
 
+#ifdef OS_HOST
+/* Host build of the kernel sources, e.g. tools/schedbench.c */
+#define os_enable_interrupts()
+#define os_disable_interrupts()
+#define os_lock_interrupts(s)       { (s) = 0; }
+#define os_unlock_interrupts(s)     { (void)(s); }
+#else
+#include "xc.h"
+
 //#include <interrupt.h>
 //#define os_enable_interrupts()  __enable_irq()
 //#define os_disable_interrupts() __disable_irq()
@@ -45,4 +52,10 @@
 #define os_enable_interrupts() {GIE=1;}
 #define os_disable_interrupts() {GIE=0;}
 
+/* Hold interrupts off and restore them as they were, s is a uint8_t. For code that */
+/* also runs in an ISR or before os_start(), where they must not be turned on.      */
+#define os_lock_interrupts(s)       { (s) = GIE; GIE = 0; }
+#define os_unlock_interrupts(s)     { GIE = (s); }
+#endif
+
 #endif
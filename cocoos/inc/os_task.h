@@ -92,6 +92,8 @@ void os_task_kill( uint8_t tid );
 uint8_t os_task_prio_get( uint8_t tid );
 void os_task_clear_wait_queue( uint8_t tid );
 void os_task_wait_time_set( uint8_t tid, uint8_t id, uint32_t time );
+void os_task_wait_until_set( uint8_t tid, uint32_t deadline );
+void os_task_wait_period_set( uint8_t tid, uint32_t period );
 void os_task_wait_event( uint8_t tid, Evt_t eventId, uint8_t waitSingleEvent, uint32_t timeout );
 void os_task_tick( uint8_t id, uint32_t tickSize );
 void os_task_signal_event( Evt_t eventId );
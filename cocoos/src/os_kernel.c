@@ -43,6 +43,16 @@ uint8_t running_tid;
 uint8_t last_running_task;
 uint8_t running;
 
+#if (OS_DEFERRED_TICK)
+static void os_tick_process( void );
+
+volatile uint8_t os_tick_count;     /* ticks counted by os_tick(), wraps */
+static uint8_t os_tick_done;        /* ticks applied to the task timers */
+static uint32_t os_ticks;           /* ticks applied since os_init() */
+#else
+static volatile uint32_t os_ticks;
+#endif
+
 /*********************************************************************************/
 /*  void os_init()                                              *//**
 *   
@@ -65,6 +75,11 @@ void os_init( void ) {
 	running_tid = NO_TID;
     last_running_task = NO_TID;
     running = 0;
+#if (OS_DEFERRED_TICK)
+    os_tick_count = 0;
+    os_tick_done = 0;
+#endif
+    os_ticks = 0;
     os_sem_init();
     os_event_init();
     os_msgQ_init();
@@ -76,6 +91,10 @@ void os_init( void ) {
 
 static void os_schedule( void ) {
 
+#if (OS_DEFERRED_TICK)
+    os_tick_process();
+#endif
+
     running_tid = NO_TID;
 
 #if (ROUND_ROBIN)
@@ -135,6 +154,8 @@ void os_start( void ) {
 *
 *   @return None.
 *   @remarks \b Usage: @n Should be called periodically. Preferably from the clock tick ISR.
+*   With OS_DEFERRED_TICK the tick is only counted here, and applied to the task timers by
+*   the scheduler loop. os_tick_ISR() does the same without the function call.
 *
 *   @code
 *   ISR(SIG_OVERFLOW0) {
@@ -147,8 +168,54 @@ void os_start( void ) {
 */
 /*********************************************************************************/
 void os_tick( void ) {
+#if (OS_DEFERRED_TICK)
+    /* Master clock tick, applied by the scheduler */
+    ++os_tick_count;
+#else
     /* Master clock tick */
+    ++os_ticks;
     os_task_tick( 0, 1 );
+#endif
+}
+
+
+#if (OS_DEFERRED_TICK)
+/* Applies the ticks counted since the last call, in one step. The tick count is a single */
+/* byte, read and written by the ISR in one instruction, so no interrupt lock is needed.  */
+static void os_tick_process( void ) {
+    uint8_t n;
+
+    n = os_tick_count - os_tick_done;
+    if ( n != 0 ) {
+        os_tick_done += n;
+        os_ticks += n;
+        os_task_tick( 0, n );
+    }
+}
+#endif
+
+
+/*********************************************************************************/
+/*  uint32_t os_tick_get()                                              *//**
+*   
+*   Number of main clock ticks since os_init()
+*
+*   @return Tick count, wraps at 2^32.
+*   @remarks \b Usage: @n Called from task code. With OS_DEFERRED_TICK the ticks not yet
+*   applied by the scheduler are included.
+*       
+*/
+/*********************************************************************************/
+uint32_t os_tick_get( void ) {
+    uint32_t t;
+#if (OS_DEFERRED_TICK)
+    t = os_ticks + (uint8_t)( os_tick_count - os_tick_done );
+#else
+    os_disable_interrupts();
+    t = os_ticks;
+    os_enable_interrupts();
+#endif
+    return t;
 }
 
 
@@ -210,6 +277,16 @@ void os_sub_nTick( uint8_t id, uint32_t nTicks ) {
 }
 
 
+/* Ticks applied to the task timers since os_init(), the time base of task_wait_until() */
+uint32_t os_tick_applied( void ) {
+#if (OS_DEFERRED_TICK)
+    return os_ticks;
+#else
+    return os_tick_get();
+#endif
+}
+
+
 uint8_t os_running( void ) {
     return running;
 }
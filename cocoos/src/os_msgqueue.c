@@ -242,11 +242,16 @@ uint8_t os_msg_receive( Msg_t *msg, MsgQ_t queue ) {
 #endif
 }
 
-void os_msgQ_tick( MsgQ_t queue ) {
+void os_msgQ_tick( MsgQ_t queue, uint32_t nTicks ) {
 #if( N_QUEUES > 0 )
     uint8_t nextMessage;
     Msg_t *pMsg;
-    OSQueue_t *q = &msgQList[ queue ].q;
+    OSQueue_t *q;
+
+    if ( queue >= nQueues ) {
+        return;
+    }
+    q = &msgQList[ queue ].q;
     nextMessage = (q->tail+1) % q->size;
 
     uint8_t head = q->head;
@@ -255,11 +260,12 @@ void os_msgQ_tick( MsgQ_t queue ) {
     while ( nextMessage != head ) {
         pMsg = (Msg_t*)( (Mem_t)q->list + nextMessage * msgSz );
 
-        if ( pMsg->delay > 0 ) {
-            --(pMsg->delay);
-            if ( pMsg->delay == 0 ) {
-                event_ISR_signal( msgQList[ queue ].change );
-            }
+        if ( pMsg->delay > nTicks ) {
+            pMsg->delay -= nTicks;
+        }
+        else if ( pMsg->delay > 0 ) {
+            pMsg->delay = 0;
+            event_ISR_signal( msgQList[ queue ].change );
         }
         nextMessage = (nextMessage + 1) % q->size;
 
@@ -44,6 +44,7 @@ struct tcb {
   TaskState_t savedState;				///< saves the task state when suspending
   uint16_t internal_state;			///< is set when calling OS_SCHEDULE
   uint32_t time;
+  uint32_t deadline;                  ///< main clock tick count of the last task_wait_until()
   uint8_t tid;
   uint8_t prio;
   Sem_t semaphore;
@@ -66,16 +67,195 @@ static void task_waiting_event_timeout_set( tcb *task );
 static uint8_t os_task_wait_queue_empty( uint8_t tid );
 static void task_ready_set( uint8_t tid );
 static void task_killed_set( uint8_t tid );
+static void task_state_set( uint8_t tid, TaskState_t state );
 
 static tcb task_list[ N_TASKS ];
 static uint8_t nTasks = 0;
 
+#if (OS_READY_BITMAP)
+/* Ready bitmap. Each task has a slot, and the bit of its slot is set while the task is READY.  */
+/* With ROUND_ROBIN the slot is the task id, so tasks are still taken in task id order.        */
+/* Otherwise slots are ordered by priority at task_create(), slot 0 is the highest priority.   */
+/* A bit in readyGrp is set while the corresponding byte of readyMap is non-zero. The next     */
+/* task is then found with two lowest-set-bit lookups, independent of the number of tasks.     */
+#if ( N_TASKS > 64 )
+#error "OS_READY_BITMAP supports up to 64 tasks"
+#endif
+#define READY_MAP_SIZE  (( N_TASKS + 7 ) / 8 )
+
+static uint8_t readyGrp;
+static uint8_t readyMap[ READY_MAP_SIZE ];
+static uint8_t slotTid[ N_TASKS ];          ///< task id in each slot
+static uint8_t tidSlot[ N_TASKS ];          ///< slot of each task id
+
+static const uint8_t lowBit[ 16 ] = { 0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0 };
+static const uint8_t bitMask[ 8 ] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+static const uint8_t fromMask[ 8 ] = { 0xff, 0xfe, 0xfc, 0xf8, 0xf0, 0xe0, 0xc0, 0x80 };
+
+/* Index of the lowest set bit, b must not be 0 */
+static uint8_t lowest_bit( uint8_t b ) {
+    if ( b & 0x0f ) {
+        return lowBit[ b & 0x0f ];
+    }
+    return 4 + lowBit[ b >> 4 ];
+}
+
+/* Tasks are also made ready from ISRs, by os_tick() without OS_DEFERRED_TICK and by */
+/* event_ISR_signal(). The read-modify-write of the map is done with interrupts held  */
+/* off, so that a bit set by an ISR in between is not lost.                           */
+static void ready_map_set( uint8_t slot ) {
+    uint8_t byte = slot >> 3;
+    uint8_t ie;
+    os_lock_interrupts( ie );
+    readyMap[ byte ] |= bitMask[ slot & 0x07 ];
+    readyGrp |= bitMask[ byte ];
+    os_unlock_interrupts( ie );
+}
+
+static void ready_map_clear( uint8_t slot ) {
+    uint8_t byte = slot >> 3;
+    uint8_t ie;
+    os_lock_interrupts( ie );
+    readyMap[ byte ] &= ~bitMask[ slot & 0x07 ];
+    if ( readyMap[ byte ] == 0 ) {
+        readyGrp &= ~bitMask[ byte ];
+    }
+    os_unlock_interrupts( ie );
+}
+
+/* Lowest ready slot at or above slot, NO_TID if none */
+static uint8_t ready_map_from( uint8_t slot ) {
+    uint8_t byte = slot >> 3;
+    uint8_t bits;
+    uint8_t grp;
+
+    if ( byte < READY_MAP_SIZE ) {
+        bits = readyMap[ byte ] & fromMask[ slot & 0x07 ];
+        if ( bits != 0 ) {
+            return ( byte << 3 ) + lowest_bit( bits );
+        }
+        ++byte;
+    }
+    if ( byte >= 8 ) {
+        return NO_TID;
+    }
+    grp = readyGrp & fromMask[ byte ];
+    if ( grp == 0 ) {
+        return NO_TID;
+    }
+    byte = lowest_bit( grp );
+    return ( byte << 3 ) + lowest_bit( readyMap[ byte ] );
+}
+#endif
+
+#if (OS_TIMER_LIST)
+/* Timer list. Tasks waiting on the main clock are linked in order of wake-up time, and the */
+/* time of each task holds the ticks after the task before it. Tasks with the same wake-up  */
+/* time are kept in the order they started waiting. A linked task always has at least one  */
+/* tick left in total, tasks are unlinked when they time out or stop waiting otherwise.     */
+#if !(OS_DEFERRED_TICK)
+#error "OS_TIMER_LIST requires OS_DEFERRED_TICK"
+#endif
+#define TIMER_UNLINKED  0xfe
+
+static uint8_t timerHead;
+static uint8_t timerNext[ N_TASKS ];        ///< next task in the list, or TIMER_UNLINKED
+
+static void timer_list_insert( uint8_t tid ) {
+    uint32_t time = task_list[ tid ].time;
+    uint8_t prev = NO_TID;
+    uint8_t next = timerHead;
+
+    while (( next != NO_TID ) && ( task_list[ next ].time <= time )) {
+        time -= task_list[ next ].time;
+        prev = next;
+        next = timerNext[ next ];
+    }
+
+    task_list[ tid ].time = time;
+    timerNext[ tid ] = next;
+    if ( next != NO_TID ) {
+        task_list[ next ].time -= time;
+    }
+    if ( prev == NO_TID ) {
+        timerHead = tid;
+    }
+    else {
+        timerNext[ prev ] = tid;
+    }
+}
+
+/* Unlinks a task that stops waiting before its time is out. Its time is set to the ticks */
+/* that were left, as without the list.                                                  */
+static void timer_list_remove( uint8_t tid ) {
+    uint32_t time = 0;
+    uint8_t prev = NO_TID;
+    uint8_t next = timerHead;
+
+    while ( next != tid ) {
+        time += task_list[ next ].time;
+        prev = next;
+        next = timerNext[ next ];
+    }
+
+    next = timerNext[ tid ];
+    if ( next != NO_TID ) {
+        task_list[ next ].time += task_list[ tid ].time;
+    }
+    if ( prev == NO_TID ) {
+        timerHead = next;
+    }
+    else {
+        timerNext[ prev ] = next;
+    }
+    timerNext[ tid ] = TIMER_UNLINKED;
+    task_list[ tid ].time += time;
+}
+
+/* Wakes the tasks whose time is out, the rest of the list is left as it is */
+static void timer_list_tick( uint32_t tickSize ) {
+    uint8_t tid;
+    tcb *task;
+
+    while ( timerHead != NO_TID ) {
+        tid = timerHead;
+        task = &task_list[ tid ];
+        if ( task->time > tickSize ) {
+            task->time -= tickSize;
+            return;
+        }
+        tickSize -= task->time;
+        timerHead = timerNext[ tid ];
+        timerNext[ tid ] = TIMER_UNLINKED;
+        task->time = 0;
+        if ( task->state == WAITING_EVENT_TIMEOUT ) {
+            os_task_clear_wait_queue( tid );
+        }
+        task_ready_set( tid );
+    }
+}
+#endif
+
 void os_task_init( void ) {
     uint8_t i;
     uint8_t j;
     nTasks = 0;
     tcb *task;
 
+#if (OS_READY_BITMAP)
+    readyGrp = 0;
+    for ( i = 0; i < READY_MAP_SIZE; ++i ) {
+        readyMap[ i ] = 0;
+    }
+#endif
+
+#if (OS_TIMER_LIST)
+    timerHead = NO_TID;
+    for ( i = 0; i < N_TASKS; ++i ) {
+        timerNext[ i ] = TIMER_UNLINKED;
+    }
+#endif
+
     for ( i = 0; i < N_TASKS; ++i ) {
         task = &task_list[i];
         task->clockId = 0xff;
@@ -91,6 +271,7 @@ void os_task_init( void ) {
         task->taskproc = 0;
         task->tid = NO_TID;
         task->time = 0;
+        task->deadline = 0;
         task->waitSingleEvent = 0;
 
         for ( j = 0; j < sizeof( task->eventQueue.eventList); j++ ) {
@@ -152,13 +333,13 @@ uint8_t task_create( taskproctype taskproc, void *data, uint8_t prio, Msg_t *msg
 
     task->tid = nTasks;
     task->prio = prio;
-    task->state = READY;
     task->savedState = READY;
     task->semaphore = 0;
     task->internal_state = 0;
     task->taskproc = taskproc;
     task->waitSingleEvent = 0;
     task->time = 0;
+    task->deadline = 0;
     if ( poolSize > 0 ) {
         task->msgQ = os_msgQ_create( msgPool, poolSize, msgSize, task->tid );
     }
@@ -168,7 +349,39 @@ uint8_t task_create( taskproctype taskproc, void *data, uint8_t prio, Msg_t *msg
 
     task->data = data;
     os_task_clear_wait_queue( nTasks );
-    
+
+#if (OS_READY_BITMAP)
+  #if (ROUND_ROBIN)
+    slotTid[ nTasks ] = nTasks;
+    tidSlot[ nTasks ] = nTasks;
+  #else
+    {
+        /* Insert in priority order. Tasks are created before os_start() only, the */
+        /* bitmap is rebuilt from the task states for the new slot order.          */
+        uint8_t slot = nTasks;
+        uint8_t tid;
+        while (( slot != 0 ) && ( task_list[ slotTid[ slot - 1 ] ].prio > prio )) {
+            slotTid[ slot ] = slotTid[ slot - 1 ];
+            tidSlot[ slotTid[ slot ] ] = slot;
+            --slot;
+        }
+        slotTid[ slot ] = nTasks;
+        tidSlot[ nTasks ] = slot;
+
+        readyGrp = 0;
+        for ( slot = 0; slot < READY_MAP_SIZE; ++slot ) {
+            readyMap[ slot ] = 0;
+        }
+        for ( tid = 0; tid != nTasks; ++tid ) {
+            if ( task_list[ tid ].state == READY ) {
+                ready_map_set( tidSlot[ tid ] );
+            }
+        }
+    }
+  #endif
+#endif
+    task_state_set( nTasks, READY );
+
     nTasks++;
     return task->tid;
 }
@@ -273,6 +486,15 @@ void *task_get_data() {
 
 /* Finds the task with highest prio that are ready to run - used for prio based scheduling */
 uint8_t os_task_highest_prio_ready_task( void ) {
+#if (OS_READY_BITMAP)
+    uint8_t byte;
+
+    if ( readyGrp == 0 ) {
+        return NO_TID;
+    }
+    byte = lowest_bit( readyGrp );
+    return slotTid[ ( byte << 3 ) + lowest_bit( readyMap[ byte ] ) ];
+#else
     uint16_t index;
     tcb *task;
     uint8_t highest_prio_task = NO_TID;
@@ -294,11 +516,25 @@ uint8_t os_task_highest_prio_ready_task( void ) {
     }
 
     return highest_prio_task;
+#endif
 }
 
 
 /* Finds the next ready task - used when ROUND_ROBIN is defined */
 uint8_t os_task_next_ready_task( void ) {
+#if (OS_READY_BITMAP)
+    uint8_t slot;
+
+    slot = NO_TID;
+    if ( NO_TID != last_running_task ) {
+        slot = ready_map_from( tidSlot[ last_running_task ] + 1 );
+    }
+    if ( NO_TID == slot ) {
+        slot = ready_map_from( 0 );
+    }
+    last_running_task = ( NO_TID == slot ) ? NO_TID : slotTid[ slot ];
+    return last_running_task;
+#else
     uint16_t index;
     uint8_t found;
     uint8_t nChecked;
@@ -334,6 +570,7 @@ uint8_t os_task_next_ready_task( void ) {
     }
     
     return last_running_task;
+#endif
 }
 
 /* Finds the task with highest prio waiting for sem, and makes it ready to run */
@@ -342,6 +579,9 @@ void os_task_release_waiting_task( Sem_t sem ) {
 #if (ROUND_ROBIN)
 	  uint32_t longestWaitTime = 0;
     uint8_t lastCheckedTask = NO_TID;
+  #if (OS_TIMER_LIST)
+    uint32_t now = os_tick_get();
+  #endif
 #else
     uint8_t highestPrio = 255;
 #endif
@@ -359,10 +599,18 @@ void os_task_release_waiting_task( Sem_t sem ) {
 			#if (ROUND_ROBIN)
 			    /* Release the task that has waited longest */
 				lastCheckedTask = tid;
+			  #if (OS_TIMER_LIST)
+			    /* time is the tick count when the wait started */
+			    if ( now - task->time > longestWaitTime ) {
+					longestWaitTime = now - task->time;
+					foundTask = tid;
+				}
+			  #else
 			    if ( task->time > longestWaitTime ) {
 					longestWaitTime = task->time;
 					foundTask = tid;
 				}
+			  #endif
 			#else
 			    /* Release the highest prio task */
                 if ( task->prio < highestPrio ) {
@@ -381,7 +629,7 @@ void os_task_release_waiting_task( Sem_t sem ) {
 		}
 	#endif			
     if ( NO_TID != foundTask ) {
-        task_list[ foundTask ].state = READY;
+        task_state_set( foundTask, READY );
     }
 }
 
@@ -412,8 +660,14 @@ void os_task_wait_sem_set( uint8_t tid, Sem_t sem ) {
     os_assert( tid < nTasks );
     task_wait_sem_set( tid, sem );
 	
+#if (OS_TIMER_LIST)
+	/* The waiting time is measured from the tick count, tasks waiting for a */
+	/* semaphore are not visited on every tick                               */
+	task_list[ tid ].time = os_tick_get();
+#else
 	/* The time is ticked to measure waiting time */
 	task_list[ tid ].time = 0;
+#endif
 }
 
 
@@ -454,7 +708,7 @@ void os_task_resume( uint8_t tid ) {
     os_assert( tid < nTasks );
 
     if ( task_list[ tid ].state == SUSPENDED ) {
-	    task_list[ tid ].state = task_list[ tid ].savedState;
+	    task_state_set( tid, task_list[ tid ].savedState );
     }
 }
 
@@ -521,6 +775,29 @@ void os_task_wait_time_set( uint8_t tid, uint8_t id, uint32_t time ) {
 }
 
 
+/* Sets the task to wait until the main clock tick count reaches deadline. The timer counts */
+/* the ticks applied to the task timers, ticks not yet applied are already in deadline.    */
+/* A deadline that has passed leaves the task ready to run.                                */
+void os_task_wait_until_set( uint8_t tid, uint32_t deadline ) {
+    int32_t time;
+
+    os_assert( tid < nTasks );
+
+    task_list[ tid ].deadline = deadline;
+    time = (int32_t)( deadline - os_tick_applied() );
+    if ( time > 0 ) {
+        os_task_wait_time_set( tid, 0, (uint32_t)time );
+    }
+}
+
+
+/* Sets the task to wait until one period after its last deadline */
+void os_task_wait_period_set( uint8_t tid, uint32_t period ) {
+    os_assert( tid < nTasks );
+    os_task_wait_until_set( tid, task_list[ tid ].deadline + period );
+}
+
+
 void os_task_wait_event( uint8_t tid, Evt_t eventId, uint8_t waitSingleEvent, uint32_t timeout ) {
     uint8_t eventListIndex;
     uint8_t shift;
@@ -549,6 +826,18 @@ void os_task_wait_event( uint8_t tid, Evt_t eventId, uint8_t waitSingleEvent, ui
 
 void os_task_tick( uint8_t id, uint32_t tickSize ) {
     uint8_t index;
+
+#if (OS_TIMER_LIST)
+    if ( id == 0 ) {
+        timer_list_tick( tickSize );
+
+        /* Decrement the delayed message timers */
+        for ( index = 0; index != N_QUEUES; ++index ) {
+            os_msgQ_tick( index, tickSize );
+        }
+        return;
+    }
+#endif
     
     /* Search all tasks and decrement time for waiting tasks */
     for ( index = 0; index != nTasks; ++index ) {
@@ -569,14 +858,16 @@ void os_task_tick( uint8_t id, uint32_t tickSize ) {
           }
         }
     }
+#if !(OS_TIMER_LIST)
 		else if ( state ==  WAITING_SEM ) {
 			task_list[ index ].time++;
 		}
+#endif
 
         /* If the task has a message queue, decrement the delayed message timers */
         if ( id == 0 ) {
             if ( task_list[ index ].msgQ != NO_QUEUE ) {
-                os_msgQ_tick( task_list[ index ].msgQ );
+                os_msgQ_tick( task_list[ index ].msgQ, tickSize );
             }
         }
     }
@@ -669,37 +960,60 @@ uint32_t os_task_timeout_get(uint8_t tid) {
   return task_list[ tid ].time;
 }
 
+/* All task state changes go through here, to keep the ready bitmap in step */
+static void task_state_set( uint8_t tid, TaskState_t state ) {
+#if (OS_TIMER_LIST)
+    if ( timerNext[ tid ] != TIMER_UNLINKED ) {
+        timer_list_remove( tid );
+    }
+    if ((( state == WAITING_TIME ) || ( state == WAITING_EVENT_TIMEOUT ))
+     && ( task_list[ tid ].clockId == 0 )) {
+        timer_list_insert( tid );
+    }
+#endif
+#if (OS_READY_BITMAP)
+    if ( state == READY ) {
+        ready_map_set( tidSlot[ tid ] );
+    }
+    else if ( task_list[ tid ].state == READY ) {
+        ready_map_clear( tidSlot[ tid ] );
+    }
+#endif
+    task_list[ tid ].state = state;
+}
+
+
 static void task_wait_sem_set( uint8_t tid, Sem_t sem ) {
-    task_list[ tid ].state = WAITING_SEM;
+    task_state_set( tid, WAITING_SEM );
     task_list[ tid ].semaphore = sem;
 }
 
 
 static void task_ready_set( uint8_t tid ) {
-    task_list[ tid ].state = READY;
+    task_state_set( tid, READY );
 }
 
 
 static void task_suspended_set( uint8_t tid ) {
-    task_list[ tid ].state = SUSPENDED;
+    task_state_set( tid, SUSPENDED );
 }
 
 
 static void task_waiting_time_set( uint8_t tid ) {
-    task_list[ tid ].state = WAITING_TIME;
+    task_state_set( tid, WAITING_TIME );
 }
 
 
 static void task_waiting_event_set( tcb *task ) {
-    task->state = WAITING_EVENT;
+    task_state_set( task->tid, WAITING_EVENT );
 }
 
 
 static void task_waiting_event_timeout_set( tcb *task ) {
-    task->state = WAITING_EVENT_TIMEOUT;
+    task_state_set( task->tid, WAITING_EVENT_TIMEOUT );
 }
 
 
 static void task_killed_set( uint8_t tid ) {
-    task_list[ tid ].state = KILLED;
+    task_state_set( tid, KILLED );
 }
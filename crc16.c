@@ -0,0 +1,28 @@
+//-----------------------------------------------------------------------------
+// File:   crc16.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+
+#include "crc16.h"
+
+//-----------------------------------------------------------------------------
+// One byte of CRC-16/CCITT-FALSE. The eight polynomial divisions are folded 
+// into two 4-bit steps on x, which is the top byte of crc XOR b. 
+//-----------------------------------------------------------------------------
+uint16_t __section("crc16") crc16(uint16_t crc, uint8_t b)
+{
+    uint8_t x = (uint8_t)(crc >> 8) ^ b;
+    x ^= x >> 4;
+    return (uint16_t)((crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x);
+}
+
+uint16_t __section("crc16") crc16Block(const uint8_t *p, uint8_t n)
+{
+    uint16_t crc = CRC16_INIT;
+    while (n--) {crc = crc16(crc, *p++);}
+    return crc;
+}
+
+//----------------------------------------------------------------- end of file
@@ -0,0 +1,24 @@
+//-----------------------------------------------------------------------------
+// File:   crc16.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection,
+// no final XOR. Check value for ASCII "123456789" is 0x29B1. Table-less, the
+// per-byte step is a handful of shifts and XORs. 
+//-----------------------------------------------------------------------------
+
+#ifndef CRC16_H
+#define	CRC16_H
+
+#include "stdint.h"
+
+#define CRC16_INIT (0xFFFF)
+
+uint16_t crc16(uint16_t crc, uint8_t b);
+uint16_t crc16Block(const uint8_t *p, uint8_t n);
+
+#endif	/* CRC16_H */
+
+//----------------------------------------------------------------- end of file
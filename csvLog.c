@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// File:   csvLog.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Window accumulator: written by the high priority capture ISRs, read and 
+// cleared by csvLog_task() with both capture interrupts held off. csvN 
+// stops at UINT8_MAX. TMR1 gate captures are below 2^24 ticks, so their sum 
+// is at most 255 x (2^24 - 1) and fits in 32 bits. A sparse edge capture is 
+// up to 510 x 400000 ticks, 22 of those would wrap: csvCapture() then drops 
+// the capture and the line shows the mean of the ones it kept. 
+//-----------------------------------------------------------------------------
+
+#include "csvLog.h"
+#include "xc.h"
+#include "cocoos.h"
+#include "textTerm.h"
+#include "edgeDetect.h"
+#include "alarm.h"
+#include "rtc.h"
+#include "i2a.h"
+
+#define CSV_LINE_SIZE (31)     // longest line: 3 x 10 digits and u8
+
+volatile bool csvOn = false;
+static bool csvRun = false;
+static uint16_t csvPeriod = 1000;       // ms
+static volatile uint32_t csvSum;
+static volatile uint8_t csvN, csvGear;
+
+//-----------------------------------------------------------------------------
+// rate: lines per second, 1..CSV_RATE_MAX. The window restarts. 
+//-----------------------------------------------------------------------------
+void __section("csvLog") csvStart(uint8_t rate)
+{
+    csvPeriod = 1000 / rate;
+    csvRun = false;
+    csvOn = true;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Called by TMR1_GATE_ISR() and CMP1_ISR() while csvOn. 
+//-----------------------------------------------------------------------------
+void __section("csvLog") csvCapture(uint8_t gear, uint32_t ticks)
+{
+    uint32_t s = csvSum + ticks;
+    if ((s < ticks) || (csvN == UINT8_MAX)) {return;}
+    csvSum = s;
+    ++csvN;
+    csvGear = gear;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Windows are timed against rtcMillis(), the OS tick count, with
+// task_wait_until() so that the line rate does not drift with the execution
+// time of the task. Each window re-arms a single-pulse 
+// capture to have a fresh period in it at high line rates. 
+//-----------------------------------------------------------------------------
+void __section("csvLog") csvLog_task(void)
+{
+    static uint32_t due, sum, ticks;
+    static uint8_t n, gear;
+    task_open();
+    for(;;)
+    {
+        if (!csvOn) {task_wait(10); continue;}
+        if (!csvRun)
+        {
+            csvRun = true;
+            due = rtcMillis();
+            ticks = 0;
+            csvSum = 0;
+            csvN = 0;
+        }
+        due += csvPeriod;
+        edgeSingleShotRearm();
+        task_wait_until(due);
+        if (!csvOn || !csvRun) {continue;}
+        
+        //-------------------------------------------------------------
+        // Close the window
+        //-------------------------------------------------------------
+        {
+            uint8_t ieg = PIE3bits.TMR1GIE, iec = PIE2bits.C1IE;
+            PIE3bits.TMR1GIE = 0;
+            PIE2bits.C1IE = 0;
+            sum = csvSum;
+            n = csvN;
+            gear = csvGear;
+            csvSum = 0;
+            csvN = 0;
+            PIE3bits.TMR1GIE = ieg;
+            PIE2bits.C1IE = iec;
+        }
+        if (n) {ticks = sum / n;}
+        else if ((getPulsePeriod24() >> 24) == UINT8_MAX) {ticks = 0;}
+        
+        //-------------------------------------------------------------
+        // Fields go straight into the TX ring. A line is queued only if
+        // it fits as a whole, none of the calls below can then fail. 
+        //-------------------------------------------------------------
+        if (printRoom() >= CSV_LINE_SIZE)
+        {
+            printu(rtcMillis(), FMT_DEC, 0);
+            printb(',');
+            printu(ticks, FMT_DEC, 0);
+            printb(',');
+            printu(n, FMT_DEC, 0);
+            printb(',');
+            printb((uint8_t)('0' + gear));
+            printb(',');
+            printb((uint8_t)('0' + (mAlarmTripped ? ALARM_MAIN : alarmState)));
+            printb('\r');
+            printb('\n');
+        }
+    }
+    task_close(); //--------- control will never fall onto this point
+}
+
+#undef CSV_LINE_SIZE
+
+//----------------------------------------------------------------- end of file
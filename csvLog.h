@@ -0,0 +1,36 @@
+//-----------------------------------------------------------------------------
+// File:   csvLog.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Decimated CSV log on EUSART1 ("pod2 <rate>"). The capture ISRs add every 
+// pulse period to a window, csvLog_task() closes the window rate times per 
+// second and prints the mean as one line: 
+//     t_ms,ticks,n,gear,alarm
+//     t_ms   rtcMillis() when the window was closed
+//     ticks  mean pulse period in TMR1 ticks (1/16 us). Sparse edge captures
+//            are converted at 25 ms == 400000 ticks. 0 == no pulse. 
+//     n      number of captures averaged, 0 == previous ticks held
+//     gear   TLM_GEAR_xxx of the last capture
+//     alarm  ALARM_xxx, ALARM_MAIN also when the ISR fast path has tripped
+// A line is queued whole or dropped when the TX ring is full. 
+//-----------------------------------------------------------------------------
+
+#ifndef CSVLOG_H
+#define	CSVLOG_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define CSV_RATE_MAX (100)      // Hz, lines per second
+
+extern volatile bool csvOn;
+
+void csvStart(uint8_t rate);
+void csvCapture(uint8_t gear, uint32_t ticks);
+void csvLog_task(void);
+
+#endif	/* CSVLOG_H */
+
+//----------------------------------------------------------------- end of file
@@ -49,6 +49,18 @@
 #include "tmr1.h"
 #include "textTerm.h"
 #include "i2a.h"
+#include "alarm.h"
+#include "pin_manager.h"
+#include "analogOut.h"
+#include "telemetry.h"
+#include "csvLog.h"
+#include "recip.h"
+#include "rtc.h"
+#include "oscCal.h"
+
+#if OC1_REPEATER && (MALARM_TRIP_DEVICE == OC1)
+#error "OC1 cannot be both the pulse repeater and the main alarm output"
+#endif
 
 #define T0T1_INIT_VAL (45)
 #define C25MS_NO_PULSE_THRE (42*4)
@@ -94,6 +106,120 @@ bool printRealTimeData = false;
 volatile static uint8_t tmr1Byte2 = 0;
 volatile uinteger24_t t24;
 
+//-----------------------------------------------------------------------------
+// rtcStamp() time of the latest capture, written by TMR1_GATE_ISR() or 
+// CMP1_ISR(). Read it with the capture interrupts held off. 
+//-----------------------------------------------------------------------------
+volatile uinteger32_t capStamp;
+
+#if OC1_REPEATER
+//-----------------------------------------------------------------------------
+// OC1 pulse repeater (see edgeDetect.h). ocHalf is the output half-period in
+// TMR3 ticks. It is written by TMR1_GATE_ISR() or CMP1_ISR() on every new 
+// measurement, whichever gear is engaged, and read by CCP1_ISR() at every 
+// output edge. All three are high priority ISRs and never interrupt one 
+// another. A new measurement thus takes effect from the next output edge. 
+// Half-periods beyond 16 bits are counted out by ocWrap full TMR3 wraps with
+// the compare set to interrupt only, the final match toggles OC1. 
+//-----------------------------------------------------------------------------
+// PIE1bits.CCP1IE == 0 flags the repeater as stopped. 
+//-----------------------------------------------------------------------------
+#define CCP1_TOGGLE (0x02)      // CCP1M compare mode: toggle output on match
+#define CCP1_SWINT  (0x0A)      // CCP1M compare mode: interrupt only
+#define OC1_RPT_MIN_HALF (32)   // 16 us, keeps edges clear of ISR latency
+#define OC1_RPT_LEAD (256)      // 128 us, first edge after (re)start
+volatile static uinteger24_t ocHalf;
+volatile static uint8_t ocWrap;
+
+//-----------------------------------------------------------------------------
+// Called from high priority ISRs only. Clamped to 16 us..8.4 s half-period.
+//-----------------------------------------------------------------------------
+static void ocRepeaterSet(uint32_t h)
+{
+    uinteger32_t x;
+    x.value = h;
+    if (x.bytes.C3) {x.value = 0x00FFFFFF;}
+    else if (x.value < OC1_RPT_MIN_HALF) {x.value = OC1_RPT_MIN_HALF;}
+    ocHalf.bytes.C0 = x.bytes.C0;
+    ocHalf.bytes.C1 = x.bytes.C1;
+    ocHalf.bytes.C2 = x.bytes.C2;
+    if (PIE1bits.CCP1IE) {return;}
+    
+    //---------------------------------------------------------------
+    // (Re)start: first edge OC1_RPT_LEAD ticks from now. Reading
+    // TMR3L latches TMR3H (16-bit read mode). 
+    //---------------------------------------------------------------
+    x.bytes.C0 = TMR3L;
+    x.bytes.C1 = TMR3H;
+    x.words.W0 += OC1_RPT_LEAD;
+    CCPR1H = x.bytes.C1;
+    CCPR1L = x.bytes.C0;
+    ocWrap = 0;
+    CCP1CON = CCP1_TOGGLE;
+    PIR1bits.CCP1IF = 0;
+    PIE1bits.CCP1IE = 1;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Task level. Clearing CCP1CON returns the pin to OC1 LAT, which is low. The
+// high priority interrupts are held off throughout: a pending CCP1_ISR() 
+// would otherwise re-arm CCP1CON after it is cleared, and a measurement ISR
+// could restart the output between the two writes. 
+//-----------------------------------------------------------------------------
+static void ocRepeaterStop(void)
+{
+    uint8_t gie = INTCONbits.GIE;
+    INTCONbits.GIE = 0;
+    CCP1CON = 0;
+    PIE1bits.CCP1IE = 0;
+    PIR1bits.CCP1IF = 0;
+    INTCONbits.GIE = gie;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// TMR3 free-running FOSC/4 1:8 (0.5 us), 16-bit read/write. CCP1 compare is
+// based on TMR3 and left off until the first measurement. 
+//-----------------------------------------------------------------------------
+void ocRepeaterInitialize(void)
+{
+    OC1_SetLow();
+    CCP1CON = 0;
+    CCPTMRS0bits.C1TSEL = 1;
+    T3GCON = 0x00;
+    TMR3H = 0;
+    TMR3L = 0;
+    T3CON = 0x33;
+    PIE1bits.CCP1IE = 0;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Compare match on OC1. Either an intermediate TMR3 wrap of a long half-
+// period, or OC1 has just toggled and the next edge is to be scheduled. 
+//-----------------------------------------------------------------------------
+void __section("edgeDetect") CCP1_ISR(void)
+{
+    PIR1bits.CCP1IF = 0;
+    if (ocWrap)
+    {
+        if (!(--ocWrap)) {CCP1CON = CCP1_TOGGLE;}
+        return;
+    }
+    //---------------------------------------------------------------
+    // Next edge at CCPR1 + ocHalf. The low 16 bits are added to the
+    // compare register, each unit of the upper byte is one full TMR3
+    // wrap. A zero low word means the first wrap is the add itself.
+    //---------------------------------------------------------------
+    CCPR1 += ocHalf.wordL.W0;
+    ocWrap = ocHalf.bytes.C2;
+    if (!ocHalf.wordL.W0) {--ocWrap;}
+    CCP1CON = ocWrap ? CCP1_SWINT : CCP1_TOGGLE;
+    return;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // Expose capture data to the outside world. Function returns:
 //     Slow pulse  0x00FFFFFF 
@@ -210,6 +336,10 @@ void __section("edgeDetect") TMR1_GATE_ISR(void)
     // relatively infrequently to prevent repeat firing of ISR
     // eat up too much execution context. 
     //---------------------------------------------------------------
+    // Telemetry: gear of this capture is noted before it is shifted
+    // (a bit test, kept short as the timer is still stopped). 
+    //---------------------------------------------------------------
+    uint8_t tf = T1GCONbits.T1GSPM ? TLM_GEAR_SINGLE : TLM_GEAR_CONT;
     if /**/ (tmr1Byte2 < 12) {T1GCONbits.T1GSPM = 1;}
     else if (tmr1Byte2 > 24) {T1GCONbits.T1GSPM = 0;}
     
@@ -224,8 +354,44 @@ void __section("edgeDetect") TMR1_GATE_ISR(void)
     // interrupt is placed after TMR1 is turn back on. 
     //---------------------------------------------------------------    
     tmr1Byte2 = c25ms = 0;
+    RTC_STAMP(capStamp);
+    if (isFirstSampleAfterModeSwitching) {tf |= TLM_F_FIRST;}
     isFirstSampleAfterModeSwitching = false;
 
+    //---------------------------------------------------------------
+    // Main alarm fast path. Byte-wise 24-bit compare "t24 < trip" 
+    // so that no 32-bit arithmetic is pulled into this ISR. A zero
+    // threshold never trips (alarm disabled). 
+    //---------------------------------------------------------------
+    #if MALARM_FAST_TRIP
+    if ((t24.bytes.C2 < mAlarmTrip24.bytes.C2) || 
+        ((t24.bytes.C2 == mAlarmTrip24.bytes.C2) && 
+         (t24.wordL.W0 < mAlarmTrip24.wordL.W0)))
+    {
+        MALARM_FAST_TRIP_SET();
+        mAlarmTripped = true;
+    }
+    #endif
+
+    //---------------------------------------------------------------
+    // Repeater half-period in TMR3 ticks: t24/16 x Q/P. Pre-shift
+    // keeps the product within 32 bits. 
+    //---------------------------------------------------------------
+    #if OC1_REPEATER
+    ocRepeaterSet(((U24GETVALUE(t24) >> 4) * OC1_RPT_M) >> 8);
+    #endif
+
+    #if AOUT_ENABLE
+    aoutPeriod(U24GETVALUE(t24));
+    #endif
+
+    if (tlmOn)
+    {
+        if (mAlarmTripped) {tf |= TLM_F_TRIP;}
+        tlmCapture(tf, U24GETVALUE(t24));
+    }
+    if (csvOn) {csvCapture(tf & TLM_F_GEAR, U24GETVALUE(t24));}
+
     return;
 }
 
@@ -237,6 +403,8 @@ void __section("edgeDetect") TMR1_GATE_ISR(void)
 void __section("edgeDetect") CMP1_ISR(void) 
 {
     static bool polarity;
+    RTC_STAMP(capStamp);
+    uint8_t tf = isFirstSampleAfterModeSwitching ? TLM_F_FIRST : 0;
     isFirstSampleAfterModeSwitching = false;
     if (polarity)
         { polarity = false; t0 = c25ms; }
@@ -244,6 +412,26 @@ void __section("edgeDetect") CMP1_ISR(void)
         { polarity = true;  t1 = c25ms; }
     c25ms = 0; 
 
+    //---------------------------------------------------------------
+    // Repeater half-period in TMR3 ticks from t0 + t1 in 25 ms steps
+    // (50000 ticks): (t0+t1) x 25000 x M/256 == (t0+t1) x M x 3125/32
+    // Capped at 0xFFFFFF ticks before the multiply by 3125. 
+    //---------------------------------------------------------------
+    #if OC1_REPEATER
+    {
+        uint32_t h = (uint16_t)(t0 + t1) * OC1_RPT_M;
+        if (h > (0x00FFFFFFUL*32/3125)) {h = 0x00FFFFFFUL*32/3125;}
+        ocRepeaterSet((h * 3125) >> 5);
+    }
+    #endif
+
+    //---------------------------------------------------------------
+    // Analog output from t0 + t1 in 25 ms steps == 400000 ticks
+    //---------------------------------------------------------------
+    #if AOUT_ENABLE
+    aoutPeriod((uint16_t)(t0 + t1) * 400000UL);
+    #endif
+
     //---------------------------------------------------------------
     // Important: reading or writing CM1CON0 clears mismatch
     //            condition otherwise testing show this code cannot
@@ -261,19 +449,39 @@ void __section("edgeDetect") CMP1_ISR(void)
     
     PIR2bits.C1IF = 0;
 
+    if (tlmOn)
+    {
+        if (mAlarmTripped) {tf |= TLM_F_TRIP;}
+        tlmCapture(tf | TLM_GEAR_SPARSE, (uint16_t)(t0 + t1));
+    }
+    if (csvOn) {csvCapture(TLM_GEAR_SPARSE, (uint16_t)(t0 + t1) * 400000UL);}
+
     return;
 }
 
 //-----------------------------------------------------------------------------
-// RAM reserved for strings to be composed and put to EUSART1
+// cmpTrigMv() : trigger voltage in mV, looked up by the DAC code in VREFCON2.
+// The table is computed by the compiler from the same parameters as 
+// CMP_V_THRES, no floating point code is run. 
 //-----------------------------------------------------------------------------
-static char s0[12], s1[12], s2[12], s3[12];
+#if DAC_N_BIT != 5
+#error "cmpMvTable[] has 32 entries for a 5-bit DAC"
+#endif
+const uint16_t __section("edgeDetect") cmpMvTable[1 << DAC_N_BIT] = \
+{
+    CMP_MV( 0), CMP_MV( 1), CMP_MV( 2), CMP_MV( 3),
+    CMP_MV( 4), CMP_MV( 5), CMP_MV( 6), CMP_MV( 7),
+    CMP_MV( 8), CMP_MV( 9), CMP_MV(10), CMP_MV(11),
+    CMP_MV(12), CMP_MV(13), CMP_MV(14), CMP_MV(15),
+    CMP_MV(16), CMP_MV(17), CMP_MV(18), CMP_MV(19),
+    CMP_MV(20), CMP_MV(21), CMP_MV(22), CMP_MV(23),
+    CMP_MV(24), CMP_MV(25), CMP_MV(26), CMP_MV(27),
+    CMP_MV(28), CMP_MV(29), CMP_MV(30), CMP_MV(31)
+};
 
-char __section("edgeDetect") *cmpTrigVoltage(void)
+uint16_t __section("edgeDetect") cmpTrigMv(void)
 {
-    static char s[12];
-    u32_a12_d((uint32_t)((CMP_V_THRES*CMP_PD_R_TOTAL/CMP_PD_R_DIVIDE+CMP_V_DIODE)*1000), 10-3, s);
-    return s;
+    return cmpMvTable[VREFCON2 & ((1 << DAC_N_BIT) - 1)];
 }
 
 void __section("edgeDetect") realTimeReport_task(void)
@@ -290,23 +498,28 @@ void __section("edgeDetect") realTimeReport_task(void)
     // least one statement giving control back to OS. 
     //---------------------------------------------------------------
     for(;;) {
-        task_wait( 1000 );
+        task_wait_period( 1000 );
         if (printRealTimeData)
         {
             #define CORRECTION_VALUE (0)
+            #define RT_REPORT_PRINTC (8)  // printc() calls per report
+            #define RT_REPORT_BYTES  (40) // printu() digits, 6+8+10+11
             //-------------------------------------------------------
-            // Code block below could interlace (may interfere with) 
-            // printing in textTerm.c.
+            // A report is queued whole or not at all: while a command
+            // reply still fills the TX queues this second is skipped
+            // rather than losing labels between the values. 
             //-------------------------------------------------------
+            if ((printcRoom() < RT_REPORT_PRINTC) 
+             || (printRoom() < RT_REPORT_BYTES)) {continue;}
             if (sparseEdgeMode)
             {
                 //---------------------------------------------------
                 // Note: power on startup is "Slow pulses" 
                 //---------------------------------------------------
                 if (c25ms >= C25MS_NO_PULSE_THRE)
-                    { printa((char*)"No pulse\r\n\r\n\0"); }
+                    { printc("No pulse\r\n\r\n\0"); }
                 else
-                    { printa((char*)"Slow pulses\r\n\r\n\0"); }
+                    { printc("Slow pulses\r\n\r\n\0"); }
             }
             else
             {
@@ -321,88 +534,37 @@ void __section("edgeDetect") realTimeReport_task(void)
                 if (f.value)
                 {
                     f.value += CORRECTION_VALUE;
-                    char u[11];
                     
                     //-----------------------------------------------
-                    // Hexadecimal output raw data. '3' == 24-bit
-                    //-----------------------------------------------
-                    trimLeft(u32_to_hex(f, 3), s0);
-                    printa((char*)"Raw data  \0");
-                    printa((char*)s0);
-                    printa((char*)" ticks\r\n\0");
-
+                    // Queue to textTerm for transmission on EUSART1,
+                    // values formatted straight into the TX ring: 
+                    // hexadecimal raw data ('3' == 24-bit), decimal 
+                    // ticks, then micro-seconds (TMR is configured to
+                    // FOSC/4 == 64/4 == 16 steps per micro-second, 
+                    // corrected by the oscillator calibration) and
+                    // Hz to 2 decimal places. 
                     //-----------------------------------------------
-                    // fire an event to u32Toa11_task() which 
-                    // performs i2a conversion where after each digit
-                    // returns control to OS scheduler to prevent 
-                    // execution contention. 
-                    //-----------------------------------------------
-                    u32Operant = f.value;
-                    event_signal( u32GoEvent );
-                    event_wait( u32DoneEvent );
-
-                    //-----------------------------------------------
-                    // Remove leading white space
-                    //-----------------------------------------------
-                    trimLeft(u32string, s1);
-
-                    //-----------------------------------------------
-                    // Send to textTerm print_task() stream to EUSART
-                    //-----------------------------------------------
-                    printa((char*)"Decimal   \0");
-                    printa((char*)s1);
-                    printa((char*)" ticks\r\n\0");
-
-                    //-----------------------------------------------
-                    // Next output the equivalent micro-seconds. TMR
-                    // is configured to FOSC/4 == 64/4 == 16 steps 
-                    // per micro-second.
-                    //-----------------------------------------------
-                    u32Operant = f.value * 100 / 16;
-                    //-----------------------------------------------
-                    task_wait(1); //-- yield to let the event resolve
-                    //-----------------------------------------------
-                    event_signal( u32GoEvent );
-                    event_wait( u32DoneEvent );
-
-                    //-----------------------------------------------
-                    // Add decimal point + remove leading white space
-                    //-----------------------------------------------
-                    insertAt(u32string, u, '.', 10-2);
-                    trimLeft(u, s2);
-
-                    //-----------------------------------------------
-                    // Send to textTerm print_task() stream to EUSART
-                    //-----------------------------------------------
-                    printa((char*)"Interval  \0");
-                    printa((char*)s2);
-                    printa((char*)" us\r\n\0");
-                    
-                    u32Operant = (uint32_t)(100*1000000*16) / f.value;
-                    //-----------------------------------------------
-                    task_wait(1); //-- yield to let the event resolve
-                    //-----------------------------------------------
-                    event_signal( u32GoEvent );
-                    event_wait( u32DoneEvent );
-
-                    //-----------------------------------------------
-                    // Add decimal point + remove leading white space
-                    //-----------------------------------------------
-                    insertAt(u32string, u, '.', 10-2);
-                    trimLeft(u, s3);
-
-                    //-----------------------------------------------
-                    // Send to textTerm print_task() stream to EUSART
-                    //-----------------------------------------------
-                    printa((char*)"Frequency \0");
-                    printa((char*)s3);
-                    printa((char*)" Hz\r\n\r\n\0");
+                    printc("Raw data  \0");
+                    printu(f.value, FMT_HEX(3), 0);
+                    printc(" ticks\r\n\0");
+                    printc("Decimal   \0");
+                    printu(f.value, FMT_DEC, 0);
+                    printc(" ticks\r\n\0");
+                    printc("Interval  \0");
+                    f.value = oscNominal(f.value);
+                    printu(recipPeriodUs100(f.value), FMT_FIX(2), 0);
+                    printc(" us\r\n\0");
+                    printc("Frequency \0");
+                    printu(recipPeriodHz100(f.value), FMT_FIX(2), 0);
+                    printc(" Hz\r\n\r\n\0");
                 }
                 else
                 {
-                    printa((char*)"Overflow\r\n\r\n\0");
+                    printc("Overflow\r\n\r\n\0");
                 }
             }
+            #undef RT_REPORT_BYTES
+            #undef RT_REPORT_PRINTC
             #undef CORRECTION_VALUE
         }
     }
@@ -412,6 +574,16 @@ void __section("edgeDetect") realTimeReport_task(void)
     task_close();
 }
 
+//-----------------------------------------------------------------------------
+// Re-arm single-pulse capture if the last one is done, for consumers that 
+// sample faster than senseTrigger_task() re-arms it. 
+//-----------------------------------------------------------------------------
+void __section("edgeDetect") edgeSingleShotRearm(void)
+{
+    if (!sparseEdgeMode && T1GSPM && !T1GGO_nDONE) {T1GGO=1;}
+    return;
+}
+
 void __section("edgeDetect") senseTrigger_task(void)
 {
     task_open();
@@ -420,7 +592,7 @@ void __section("edgeDetect") senseTrigger_task(void)
     for(;;)
     {
         static uint8_t j = 0;
-        task_wait( 25 );
+        task_wait_period( 25 ); //------ 25 ms grid, c25ms does not drift
         
         //-----------------------------------------------------------
         // c100ms runs up to limit value at which point it cease to
@@ -499,17 +671,37 @@ void __section("edgeDetect") senseTrigger_task(void)
             sparseEdgeMode = isFirstSampleAfterModeSwitching = true;
             j = 3;
             //-------------------------------------------------------
+            // No edge for 2 seconds: repeater output stops until the
+            // first edge pair measured in sparse edge mode. 
+            //-------------------------------------------------------
+            #if OC1_REPEATER
+            ocRepeaterStop();
+            #endif
+            //-------------------------------------------------------
             // Debugging code to ascertain state regularity 2/2
             //-------------------------------------------------------
             //LED_BLUE_SetLow(); // Low == ON
         }
         
+        //-----------------------------------------------------------
+        // Binary telemetry wants every capture it can get: single-
+        // pulse mode is re-triggered every 25 ms instead of 100 ms. 
+        //-----------------------------------------------------------
+        if (tlmOn && !sparseEdgeMode && T1GSPM && !T1GGO_nDONE) {T1GGO=1;}
+        
         //-----------------------------------------------------------
         // 100 millisecond section
         //-----------------------------------------------------------
         if (++j < 4) {continue;}
         j = 0;
         
+        #if OC1_REPEATER
+        if (sparseEdgeMode && (c25ms >= C25MS_NO_PULSE_THRE)) {ocRepeaterStop();}
+        #endif
+        #if AOUT_ENABLE
+        if (sparseEdgeMode && (c25ms >= C25MS_NO_PULSE_THRE)) {AOUT_LOAD(0);}
+        #endif
+        
         if (!sparseEdgeMode)
         {
             //-------------------------------------------------------
@@ -557,6 +749,12 @@ void __section("edgeDetect") senseTrigger_task(void)
     task_close();
 }
 
+#if OC1_REPEATER
+#undef OC1_RPT_LEAD
+#undef OC1_RPT_MIN_HALF
+#undef CCP1_SWINT
+#undef CCP1_TOGGLE
+#endif
 #undef C25MS_NO_PULSE_THRE
 #undef T0T1_INIT_VAL
 
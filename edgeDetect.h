@@ -17,6 +17,7 @@ extern "C" {
 #include <xc.h>
 #include "cmp1.h"
 #include "dac.h"
+#include "uintegers2.h"
     
 //-----------------------------------------------------------------------------
 // DAC parameters
@@ -43,20 +44,54 @@ extern "C" {
 #define CMP_V_THRES ((DAC_V_HI-DAC_V_LO)*VREFCON2/(1<<DAC_N_BIT)+DAC_V_LO)
 #define DAC_VREFCON2(v) ((uint8_t)((1<<DAC_N_BIT)*(v-DAC_V_LO)/(DAC_V_HI-DAC_V_LO))
 
+//-----------------------------------------------------------------------------
+// Trigger voltage at the input terminal in mV for DAC code c, i.e. the DAC 
+// output scaled up by the PD plus the diode drop, rounded. For constant c the
+// compiler folds the floating point arithmetic, used to build cmpMvTable[]. 
+//-----------------------------------------------------------------------------
+#define CMP_MV(c) ((uint16_t)((((DAC_V_HI-DAC_V_LO)*(c)/(1<<DAC_N_BIT)+DAC_V_LO)\
+    *CMP_PD_R_TOTAL/CMP_PD_R_DIVIDE+CMP_V_DIODE)*1000+0.5))
+
 //-----------------------------------------------------------------------------
 // Comparator 1 output gates 16-bit timer 1 which is set to FOSC/4 using MCC
 //-----------------------------------------------------------------------------
 #define TMR1_OVERFLOW_US (4096)   
 
+//-----------------------------------------------------------------------------
+// OC1 pulse repeater. OC1_REPEATER 1 == OC1 regenerates the sensed speed pulse
+// as a 50% square wave at OC1_RPT_P/OC1_RPT_Q times the input frequency. The
+// output edges are timed by CCP1 compare (toggle) against free-running TMR3
+// at 0.5 us per tick. OC1 is then no longer an audioVisual device. 
+// 0 == OC1 is driven by audioVisual as before. 
+//-----------------------------------------------------------------------------
+// The ratio is applied as Q8 multiplier OC1_RPT_M = 256 x Q/P, so that the 
+// ISRs do a multiply and shifts only. Q/P is limited to 16, and P/Q to 256 
+// where the multiplier becomes coarse (P/Q <= 16 keeps error below 3%). 
+//-----------------------------------------------------------------------------
+#define OC1_REPEATER (0)
+#define OC1_RPT_P    (1)
+#define OC1_RPT_Q    (1)
+#define OC1_RPT_M    ((256UL*OC1_RPT_Q+OC1_RPT_P/2)/OC1_RPT_P)
+#if OC1_REPEATER && ((OC1_RPT_M < 1) || (OC1_RPT_M > 4095))
+#error "OC1_RPT_P/OC1_RPT_Q out of range"
+#endif
+
+
 //-----------------------------------------------------------------------------
 // Functions and variables to be exposed to any code module that #include this
 // header file.
 //-----------------------------------------------------------------------------
 extern bool printRealTimeData;
-char* cmpTrigVoltage(void);
+extern volatile uinteger32_t capStamp;
+uint16_t cmpTrigMv(void);
 void realTimeReport_task(void); 
 void senseTrigger_task(void);
 uint32_t getPulsePeriod24(void);
+void edgeSingleShotRearm(void);
+#if OC1_REPEATER
+void ocRepeaterInitialize(void);
+void CCP1_ISR(void);
+#endif
 
 #ifdef	__cplusplus
 }
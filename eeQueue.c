@@ -0,0 +1,162 @@
+//-----------------------------------------------------------------------------
+// File:   eeQueue.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Queued data EEPROM writes completed by the EEIF interrupt, see eeQueue.h. 
+//-----------------------------------------------------------------------------
+
+#include "xc.h"
+#include "eeQueue.h"
+#include "memory.h"
+#include "stddef.h"
+
+//-----------------------------------------------------------------------------
+// Queue of address and data. Head is written by task code only, tail by the
+// ISR only (indices free-running, masked on access), as the TX ring in 
+// textTerm.c. eeBusy is true from the start of the first write until the 
+// ISR finds the queue empty. 
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    uint16_t a;
+    uint8_t d;
+}
+eeEntry_t;
+static eeEntry_t eeQ[EEQ_SIZE];
+static volatile uint8_t eeHead, eeTail;
+static volatile bool eeBusy = false;
+volatile uint8_t eeErrors = 0;
+
+//-----------------------------------------------------------------------------
+// Start the write of the next entry whose byte differs from the EEPROM, the 
+// others are dropped unwritten (write-if-changed, no wear for an unchanged 
+// value). Clears eeBusy if none is left. Unlock sequence as in 
+// DATAEE_WriteByte(), with all interrupts held off for the three writes. 
+// Expanded in place so that ISR and task code do not share a function. 
+//-----------------------------------------------------------------------------
+#define EE_NEXT() {\
+    eeEntry_t *e = NULL;\
+    while (eeTail != eeHead)\
+    {\
+        e = &eeQ[eeTail & (EEQ_SIZE-1)];\
+        EEADRH = (uint8_t)((e->a >> 8) & 0x03);\
+        EEADR = (uint8_t)e->a;\
+        EECON1bits.EEPGD = 0;\
+        EECON1bits.CFGS = 0;\
+        EECON1bits.RD = 1;\
+        NOP();\
+        NOP();\
+        if (EEDATA != e->d) {break;}\
+        ++eeTail;\
+    }\
+    if (eeTail == eeHead) {eeBusy = false;}\
+    else\
+    {\
+        uint8_t gie = INTCONbits.GIE;\
+        EEDATA = e->d;\
+        EECON1bits.WREN = 1;\
+        INTCONbits.GIE = 0;\
+        EECON2 = 0x55;\
+        EECON2 = 0xAA;\
+        EECON1bits.WR = 1;\
+        INTCONbits.GIE = gie;\
+    }}
+
+//-----------------------------------------------------------------------------
+// EEIF at low priority, it is a slow event. 
+//-----------------------------------------------------------------------------
+void __section("eeQueue") eeInitialize(void)
+{
+    IPR2bits.EEIP = 0;
+    PIR2bits.EEIF = 0;
+    PIE2bits.EEIE = 1;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// eeWrite_ISR() : called by the low priority interrupt manager on EEIF. The 
+// byte just written is read back (EEADR still holds its address), then the 
+// next write is started. 
+//-----------------------------------------------------------------------------
+void __section("eeQueue") eeWrite_ISR(void)
+{
+    PIR2bits.EEIF = 0;
+    EECON1bits.WREN = 0;
+    EECON1bits.RD = 1;
+    NOP();
+    NOP();
+    if ((EEDATA != eeQ[eeTail & (EEQ_SIZE-1)].d) || EECON1bits.WRERR) 
+    {
+        EECON1bits.WRERR = 0;
+        ++eeErrors;
+    }
+    ++eeTail;
+    EE_NEXT();
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// eeWriteBlock()
+// Input:  n bytes at p to EEPROM address a..a+n-1, copied to the queue. 
+// Output: true  == queued
+//         false == not enough room, nothing is queued
+// The first write is started here if the EEPROM is idle. eeHead is moved 
+// before eeBusy is tested: an ISR in between either sees the new entries or
+// has already cleared eeBusy. With eeBusy clear no write is in progress and
+// no EEIF can come, task code then owns eeTail until a write is started. 
+//-----------------------------------------------------------------------------
+bool __section("eeQueue") eeWriteBlock(uint16_t a, const uint8_t *p, uint8_t n)
+{
+    uint8_t h = eeHead;
+    if (n > (uint8_t)(EEQ_SIZE - (uint8_t)(h - eeTail))) {return false;}
+    while (n--)
+    {
+        eeQ[h & (EEQ_SIZE-1)].a = a++;
+        eeQ[h & (EEQ_SIZE-1)].d = *p++;
+        ++h;
+    }
+    eeHead = h;
+    if (!eeBusy)
+    {
+        eeBusy = true;
+        EE_NEXT();
+    }
+    return true;
+}
+
+bool __section("eeQueue") eeWrite(uint16_t a, uint8_t d)
+{
+    return eeWriteBlock(a, &d, 1);
+}
+
+uint8_t __section("eeQueue") eeRoom(void)
+{
+    return (uint8_t)(EEQ_SIZE - (uint8_t)(eeHead - eeTail));
+}
+
+bool __section("eeQueue") eeIdle(void)
+{
+    return !eeBusy;
+}
+
+//-----------------------------------------------------------------------------
+// eeFlush() : wait until all queued bytes are written. Blocks, for use where
+// yielding is not possible (command handlers, before a reset). 
+//-----------------------------------------------------------------------------
+void __section("eeQueue") eeFlush(void)
+{
+    while (eeBusy) {}
+    return;
+}
+
+uint8_t __section("eeQueue") eeRead(uint16_t a)
+{
+    eeFlush();
+    return DATAEE_ReadByte(a);
+}
+
+#undef EE_NEXT
+
+//----------------------------------------------------------------- end of file
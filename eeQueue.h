@@ -0,0 +1,42 @@
+//-----------------------------------------------------------------------------
+// File:   eeQueue.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Non-blocking data EEPROM writes. DATAEE_WriteByte() spins about 4 ms per 
+// byte with the scheduler stopped. Here bytes are queued, each write is 
+// started and the next one chained from the EEIF (write complete) interrupt,
+// so task code returns at once and the EEPROM is written in the background.
+// Every byte is read back after its write, mismatches are counted. A byte 
+// already holding the queued value is not written at all. 
+//-----------------------------------------------------------------------------
+// Reads must not overlap a write: use eeRead(), which flushes first. 
+// eeFlush() waits on the interrupt, i.e. needs interrupts enabled. Task code
+// that must know its data is stored uses ee_wait() instead, which yields. 
+//-----------------------------------------------------------------------------
+
+#ifndef EEQUEUE_H
+#define	EEQUEUE_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define EEQ_SIZE (32)   // queued bytes, power of 2, <= 128
+
+extern volatile uint8_t eeErrors;   // read-back mismatches since reset
+
+void eeInitialize(void);
+bool eeWrite(uint16_t a, uint8_t d);
+bool eeWriteBlock(uint16_t a, const uint8_t *p, uint8_t n);
+uint8_t eeRoom(void);
+bool eeIdle(void);
+void eeFlush(void);
+uint8_t eeRead(uint16_t a);
+void eeWrite_ISR(void);
+
+#define ee_wait()   while (!eeIdle()) {task_wait(1);}
+
+#endif	/* EEQUEUE_H */
+
+//----------------------------------------------------------------- end of file
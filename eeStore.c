@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// File:   eeStore.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Wear-levelled record rings, see eeStore.h. 
+//-----------------------------------------------------------------------------
+
+#include "eeStore.h"
+#include "eeQueue.h"
+#include "crc16.h"
+#include "uintegers2.h"
+
+//-----------------------------------------------------------------------------
+// eeRingLoad()
+// Input:  r as set up by EE_RING(), rec room for r->size bytes
+// Output: true  == the newest valid record is in rec, r points at it
+//         false == no valid slot, rec is unchanged, the first save goes to
+//                  slot 0
+// Each slot is checked by streaming its bytes through the CRC, no slot 
+// buffer is needed. 
+//-----------------------------------------------------------------------------
+bool __section("eeStore") eeRingLoad(eeRing_t *r, void *rec)
+{
+    uint16_t a = r->base;
+    uinteger32_t g;
+    uint16_t crc;
+    uint8_t i, k;
+    
+    r->gen = 0;
+    r->newest = r->slots - 1;
+    for (k = 0; k < r->slots; ++k, a += EE_SLOT(r->size))
+    {
+        crc = CRC16_INIT;
+        for (i = 0; i < 4; ++i)
+        {
+            ((uint8_t*)&g.value)[i] = eeRead(a + i);
+            crc = crc16(crc, ((uint8_t*)&g.value)[i]);
+        }
+        for (i = 0; i < r->size; ++i) {crc = crc16(crc, eeRead(a + 4 + i));}
+        if ((eeRead(a + 4 + i) != (uint8_t)crc) 
+         || (eeRead(a + 5 + i) != (uint8_t)(crc >> 8))) {continue;}
+        if (g.value > r->gen) {r->gen = g.value; r->newest = k;}
+    }
+    if (!r->gen) {return false;}
+    
+    a = r->base + EE_SLOT(r->size) * r->newest + 4;
+    for (i = 0; i < r->size; ++i) {((uint8_t*)rec)[i] = eeRead(a + i);}
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// eeRingSave() : rec is queued to the slot after the newest. Waits for the 
+// write queue only when it has no room for the whole slot. 
+// Output: false == the slot could not be queued, r is unchanged
+//-----------------------------------------------------------------------------
+bool __section("eeStore") eeRingSave(eeRing_t *r, const void *rec)
+{
+    uint8_t k = (r->newest + 1 < r->slots) ? r->newest + 1 : 0;
+    uint16_t a = r->base + EE_SLOT(r->size) * k;
+    uinteger32_t g;
+    uint16_t crc;
+    uint8_t c[2];
+    
+    g.value = r->gen + 1;
+    crc = crc16Block((const uint8_t*)&g.value, 4);
+    for (uint8_t i = 0; i < r->size; ++i) 
+        {crc = crc16(crc, ((const uint8_t*)rec)[i]);}
+    c[0] = (uint8_t)crc;
+    c[1] = (uint8_t)(crc >> 8);
+    
+    if (eeRoom() < EE_SLOT(r->size)) {eeFlush();}
+    if (!eeWriteBlock(a, (const uint8_t*)&g.value, 4)) {return false;}
+    eeWriteBlock(a + 4, (const uint8_t*)rec, r->size);
+    eeWriteBlock(a + 4 + r->size, c, 2);
+    r->newest = k;
+    r->gen = g.value;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// eeRingWear() : most writes any cell of the ring has seen, gen / slots 
+// rounded up. An upper bound, bytes saved unchanged are not written. 
+//-----------------------------------------------------------------------------
+uint32_t __section("eeStore") eeRingWear(const eeRing_t *r)
+{
+    return (r->gen + r->slots - 1) / r->slots;
+}
+
+//----------------------------------------------------------------- end of file
@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+// File:   eeStore.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Wear-levelled record storage over the data EEPROM. A record that is saved 
+// often rotates over a ring of slots instead of wearing one set of cells: 
+//     slot = gen (uint32_t, LSB first) | record | crc16Block() of both
+// A save goes to the slot after the newest one with gen + 1, so every cell 
+// of the ring is written once per `slots` saves. At load the valid slot with
+// the highest gen wins. A save cut short by power loss fails its CRC and the
+// previous record is loaded. Writes go through eeQueue.c, which also skips 
+// bytes that are unchanged. Regions are allocated in the EEPROM map in 
+// opParam.h. 
+//-----------------------------------------------------------------------------
+
+#ifndef EESTORE_H
+#define	EESTORE_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "eeQueue.h"
+
+#define EE_ENDURANCE (100000UL) // data EEPROM E/W cycles per cell (typical)
+
+//-----------------------------------------------------------------------------
+// EEPROM bytes taken by a ring of n slots of records of size bytes. size is 
+// at most EEQ_SIZE - 6 so that a slot fits the write queue in one go, else 
+// every eeRingSave() fails. EE_SLOT_CHECK() enforces this at compile time 
+// (negative array size), once per record type at file scope. 
+//-----------------------------------------------------------------------------
+#define EE_SLOT(size)         ((size) + 6)
+#define EE_RING_SPAN(size, n) ((uint16_t)EE_SLOT(size) * (n))
+#define EE_SLOT_CHECK(name, size) \
+    typedef char name[(EE_SLOT(size) <= EEQ_SIZE) ? 1 : -1]
+
+typedef struct
+{
+    uint16_t base;      // EEPROM address of slot 0
+    uint8_t  slots;
+    uint8_t  size;      // record bytes
+    uint8_t  newest;    // slot of the newest record
+    uint32_t gen;       // its gen, 0 == nothing stored yet
+}
+eeRing_t;
+#define EE_RING(base, size, n) {(base), (n), (size), (n) - 1, 0}
+
+bool eeRingLoad(eeRing_t *r, void *rec);
+bool eeRingSave(eeRing_t *r, const void *rec);
+uint32_t eeRingWear(const eeRing_t *r);
+
+#endif	/* EESTORE_H */
+
+//----------------------------------------------------------------- end of file
@@ -49,6 +49,8 @@ eula : Show EULA \"End User License Agreement\"\r\n\
 sysi : Enquire configuration parameters\r\n\
 pod0 : Turn off real-time data to console\r\n\
 pod1 : Turn on  real-time data (default)\r\n\
+pod2 : CSV log, lines per second 1..100\r\n\
+pod3 : Binary telemetry, COBS + CRC-16 frames\r\n\
 almset0 : All alarm levels reset\r\n\
 almset1 : Pre- alarm captured and set\r\n\
 almset2 : Main alarm captured and set\r\n\
@@ -56,6 +58,14 @@ alevel1 : Pre- alarm level set by value\r\n\
 alevel2 : Main alarm level set by value\r\n\
 volthre : Threshold voltage control byte\r\n\
 samplei : Sampling interval (x10 ms)\r\n\
+anazero : Analog output 0V frequency (Hz)\r\n\
+anafull : Analog output 5V frequency (Hz)\r\n\
+prof : Select parameter profile 0..3\r\n\
+wear : Parameter EEPROM saves and wear\r\n\
+time : Date and time (UTC)\r\n\
+settime : Set the clock, seconds since 1970-01-01 UTC\r\n\
+oscal : Calibrate oscillator, reference Hz (0 clears)\r\n\
+link : Framed link mode for machine clients\r\n\
 \r\n\
 \0";
 
@@ -74,5 +84,18 @@ const char __section("helpText") rtDataOffText[] = \
 "\r\n\
 Live capture data OFF.\r\n\0";
 
+const char __section("helpText") tlmOnText[] = \
+"\r\n\
+Binary telemetry ON. Type pod0 to stop.\r\n\0";
+
+const char __section("helpText") csvOnText[] = \
+"\r\n\
+CSV log ON. Type pod0 to stop.\r\n\
+t_ms,ticks,n,gear,alarm\r\n\0";
+
+const char __section("helpText") linkOnText[] = \
+"\r\n\
+Framed link mode follows this prompt.\r\n\0";
+
 //----------------------------------------------------------------- end of file
 
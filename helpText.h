@@ -27,6 +27,9 @@ extern const char devConfigText0[];
 
 extern const char rtDataOnText[];
 extern const char rtDataOffText[];
+extern const char tlmOnText[];
+extern const char csvOnText[];
+extern const char linkOnText[];
 
 #ifdef	__cplusplus
 }
@@ -4,8 +4,8 @@
 //
 // Created on February 11, 2020, 16:39
 //-----------------------------------------------------------------------------
-// Value to text conversion utility function and associated string manipulation
-// function - attempting to be leaner than standard sprintf(). If during code
+// Value to text and text to value conversion utility functions - attempting to
+// be leaner than standard sprintf(). If during code
 // development further sophistication is needed, this might be forgone and use
 // sprintf() instead. )
 //-----------------------------------------------------------------------------
@@ -17,241 +17,90 @@
 #include "stdbool.h"
 
 //-----------------------------------------------------------------------------
-// u32Toa11_task() : 32-bit unsigned integer convert to text representation
-//-----------------------------------------------------------------------------
-// How to use, steps: 
-//    (1) Load operant u32Numerator
-//    (2) event_signal( u32GoEvent );
-//    (3) event_wait( u32DoneEvent );
-//    (4) Obtain output u32string[]
-// i2a notes: 
-//    32-bit corresponds to "4 giga" requiring 10 digits. 
-//    The output string u32string[] will be at most 10 + 1 = 11 bytes long. 
-//    Output string is right-justified
-//    Leading digit(s) is(are) patched with space ' ' character.
-//    Retain value until the next u32GoEvent to set off computation. 
-//-----------------------------------------------------------------------------
-
-#define LENSZE (11)
-Evt_t u32GoEvent, u32DoneEvent;
-uint32_t u32Operant;
-char u32string[LENSZE];
-void __section("i2a") u32Toa11_task(void)
+// u32Fmt() : the conversion kernel of this file. x is written as text in one
+//    pass to b[at & mask], b[(at + 1) & mask], ... u32FmtLen() characters, 
+//    no '\0'. mask is 0xFF for a plain buffer, or the index mask of a ring 
+//    buffer such as the console TX ring (printu() in textTerm.c). 
+//        f : FMT_DEC, FMT_FIX(d) or FMT_HEX(n), see i2a.h
+//        w : minimum width, right-justified with leading spaces, 0 == none
+// Decimal is division-free: each digit is the count of subtractions of its 
+// power of ten, at most 9 per digit. The PIC18 has no divide instruction, 
+// x%10 and x/=10 would be two 32-bit library divisions per digit. Digits 
+// above the most significant one are skipped, FMT_FIX pads with zeros to 
+// one digit before the decimal point, e.g. 5 at FMT_FIX(2) is "0.05". 
+// Checked against printf() and the former % 10 loop by tools/fmtbench.c. 
+// There is no shared operand or result buffer and u32Fmt() never yields, so
+// any number of cooperative tasks may format at once without queuing a job.
+//-----------------------------------------------------------------------------
+const uint32_t __section("i2a") pow10L[] = \
 {
-    task_open();
-    for(;;) {
-        static uint8_t i;
-        event_wait( u32GoEvent );
-        
-        //-----------------------------------------------------------
-        // String termination character after right-most digit
-        //-----------------------------------------------------------
-        // Compose string backward, because of two observations:
-        //   (1) String is of fixed, known length
-        //   (2) This way the arithmetic is much more elegant
-        //-----------------------------------------------------------
-        // Least significant to most significant digit, right-to-left
-        // right-justified
-        //-----------------------------------------------------------
-        i = LENSZE;
-        u32string[--i] = '\0';
-        
-        //-----------------------------------------------------------
-        // Have to use "goto". Placing code block inside switch() 
-        // will result in this task permanently blocked (hung). 
-        // It looks like cocoOS doesn't like having task_wait() 
-        // nested too deeply.                               27Feb2020
-        //-----------------------------------------------------------
-        //switch (u32ConvOp)
-        //{
-        //    case U32OP_I2A_32:  goto U32LABEL0; break;
-        //    case U32OP_I2H_24:  goto U32LABEL1; break;
-        //    case U32OP_I2H_32:  goto U32LABEL2; break;
-        //    default:            goto U32LABELY; break;
-        //}
-        //-----------------------------------------------------------
-        
-        do {
-            u32string[--i] = '0'+(uint8_t)(u32Operant%10);
-            u32Operant /= 10;
-            task_wait(1); //------------- make system more responsive
-        } 
-        while (u32Operant);
+    1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10
+};
 
-        //-----------------------------------------------------------
-        // If there are unused left digit(s) patch blank space(s)
-        //-----------------------------------------------------------
-        while (i) { u32string[--i] = ' '; }
-        
-        event_signal( u32DoneEvent );
-    }
-    task_close(); //------- Control will never fall beyond this point
+static uint8_t __section("i2a") u32FmtDigits(uint32_t x, uint8_t f)
+{
+    uint8_t n, d = f & 0x0F;
+    if (f & FMT_HEX_F) {return 2 + 2 * d;}
+    for (n = 10; (n > 1) && (x < pow10L[10 - n]); --n);
+    if (n <= d) {n = d + 1;}
+    return d ? n + 1 : n;
 }
-#undef LENSZE
 
-//-----------------------------------------------------------------------------
-// u32_to_a11() : 32-bit unsigned integer to text representation
-//    x : input value to be converted to decimal text numerical representation.
-//        32-bit corresponds to "4 giga" requiring 10 digits. The output string 
-//        will be 10 + 1 = 11 bytes long.
-//    Function return value: a pointer to a string of length 11 which retains 
-//        its value until the next call to this function. The caller may use 
-//        this for further processing, and eventually perhaps have it copied 
-//        to another RAM location. Output string is right-justified, unused
-//        digit(s) is filled with space ' ' character.
-//-----------------------------------------------------------------------------
-char __section("i2a") *u32_to_a11(uint32_t x)
+uint8_t __section("i2a") u32FmtLen(uint32_t x, uint8_t f, uint8_t w)
 {
-    #define LENSZE (11)
-    static char a[LENSZE];
-    uint8_t i = LENSZE;
-    //---------------------------------------------------------------
-    // Compose string backward, because of two characteristics:
-    //   (1) String is of fixed, known length
-    //   (2) This way the arithmetic is much more elegant (efficient)
-    //---------------------------------------------------------------
-    // String termination character after right-most digit
-    //---------------------------------------------------------------
-    a[--i] = '\0';
-    //---------------------------------------------------------------
-    // Least significant to most significant digit, right-to-left
-    //---------------------------------------------------------------
-     do {
-        a[--i] = '0'+(uint8_t)(x%10);
-        x /= 10;
-    } 
-    while (x);
-    //---------------------------------------------------------------
-    // If there are unused left digit(s) patch with space character
-    //---------------------------------------------------------------
-    while (i) { a[--i] = ' '; }
-    return a;
-    #undef LENSZE
+    uint8_t n = u32FmtDigits(x, f);
+    return (w > n) ? w : n;
 }
 
-//-----------------------------------------------------------------------------
-// u32_to_hex() : a variant of *u32_to_a11(). Function call argument j is the 
-// number of lease significant bytes to be converted. For example
-//     4 = convert 4 bytes to 0x******** 10-characters
-//     3 = convert lowest 3 bytes to 0x****** patch left with spaces
-//-----------------------------------------------------------------------------
-char __section("i2a") *u32_to_hex(uinteger32_t x, uint8_t j)
+void __section("i2a") u32Fmt(uint32_t x, uint8_t f, uint8_t w, char *b, \
+    uint8_t at, uint8_t mask)
 {
-    #define LENSZE (11)
-    static char a[LENSZE]; //-------- declare static to persist value
-    uint8_t i;
-    for (i = 0; i < LENSZE; ++i) {a[i] = ' ';}
-    a[10] = '\0';
-    i = 8 ;
-    if (j >= 1)
+    uint8_t i, d = f & 0x0F, n = u32FmtDigits(x, f);
+    char c;
+    for (; w > n; --w) {b[at++ & mask] = ' ';}
+    if (f & FMT_HEX_F)
     {
-        a[9] = lowewrNibbleToAscii(x.bytes.C0);
-        a[8] = lowewrNibbleToAscii(x.bytes.C0 >> 4);
-        i -= 2;
-    }
-    if (j >= 2)
-    {
-        a[7] = lowewrNibbleToAscii(x.bytes.C1);
-        a[6] = lowewrNibbleToAscii(x.bytes.C1 >> 4);
-        i -= 2;
-    }
-    if (j >= 3)
-    {
-        a[5] = lowewrNibbleToAscii(x.bytes.C2);
-        a[4] = lowewrNibbleToAscii(x.bytes.C2 >> 4);
-        i -= 2;
+        uinteger32_t h;
+        h.value = x;
+        for (i = d; i < 4; ++i) {h.value <<= 8;} //--- top byte first
+        b[at++ & mask] = '0';
+        b[at++ & mask] = 'x';
+        while (d--)
+        {
+            b[at++ & mask] = lowewrNibbleToAscii(h.bytes.C3 >> 4);
+            b[at++ & mask] = lowewrNibbleToAscii(h.bytes.C3);
+            h.value <<= 8;
+        }
+        return;
     }
-    if (j >= 4)
+    if (d) {--n;} //---------------------------- n counts digits only
+    for (i = 10 - n; i < 9; ++i)
     {
-        a[3] = lowewrNibbleToAscii(x.bytes.C3);
-        a[2] = lowewrNibbleToAscii(x.bytes.C3 >> 4);
-        a[1] = 'x'; a[0] = '0';
-        i -= 2;
+        if (d && (i == 10 - d)) {b[at++ & mask] = '.';}
+        c = '0';
+        while (x >= pow10L[i]) {x -= pow10L[i]; ++c;}
+        b[at++ & mask] = c;
     }
-    a[i] = '0'; a[i+1] = 'x';
-    return a;
-    #undef LENSZE
-}
-
-//-----------------------------------------------------------------------------
-// trimRight() : remove trailing spaces in string *a which is done by simply
-//    inserting an extra '\0' upon finding non-space character from the right. 
-//    The processing loop terminates by encountering an end of string character 
-//    '\0'. Invalid string can cause indefinite execution and RAM corruption. 
-//-----------------------------------------------------------------------------
-void __section("i2a") trimRight(char *a)
-{
-    uint8_t i = 0;
-    while (a[i++] != '\0');         //--- go to the end of string
-    while (i > 0 && a[--i] == ' '); //--- back to first non-space
-    a[++i] = '\0';                  // put '\0' immediately after
-    return;
-}
-
-//-----------------------------------------------------------------------------
-// trimLeft() : remove leading spaces in string a, output to string b. 
-//    Calling function must ensure b[] has pre-allocated enough RAM to hold the
-//    result. size of array b must be >= size of array a. The processing loop
-//    terminates by encountering an end of string character '\0'. Invalid
-//    string can cause indefinite execution and RAM corruption. 
-//-----------------------------------------------------------------------------
-void __section("i2a") trimLeft(char *a, char *b)
-{
-    while (*a == ' ') { ++a; }     //-- move to first non-space
-    while ((*b++ = *a++) != '\0'); //---------- copy until '\0'
-    return;
-}
-
-//-----------------------------------------------------------------------------
-// insertAt() : insert given character at position specified by the caller
-//    Calling function must ensure b[] has pre-allocated enough RAM to hold the
-//    result. size of array b must be >= size of array a + 1. The processing 
-//    loop terminates by encountering an end of string character '\0'. Invalid
-//    string can cause indefinite execution and RAM corruption. Processing will 
-//    not get pass position index 255 max. String of length longer than allowed
-//    will not produce correct result. 
-//        a : original string (will be left unmodified)
-//        b : output string   (content will be changed)
-//        c : character to be inserted.
-//        p : position index of insertion, 0 is insert up front. Max. 255.
-//-----------------------------------------------------------------------------
-void __section("i2a") insertAt(char *a, char *b, char c, uint8_t p)
-{
-    uint8_t i = 0;
-    //------------------------------------------------------------------------
-    // The two while-loops terminates when end of string character is detected
-    //------------------------------------------------------------------------
-    while (i != p && (b[i] = a[i]) != '\0') {++i;} //-- copy characters across
-    b[p++] = c;                                    //-------- insert character
-    while ((b[p++] = a[i++]) != '\0');             // copy remaining character
+    if (d == 1) {b[at++ & mask] = '.';}
+    b[at & mask] = '0' + (uint8_t)x;
     return;
 }
 
 //-----------------------------------------------------------------------------
 // Convert unsigned 32 to string and optionally insert decimal point
 //     w: the binary value to be converted
-//     d: position of decimal point to be inserted (count from left)
+//     d: position of decimal point to be inserted (count from left in 10 
+//        digits), i.e. 10 - d digits after the point. 10 == no point. 
 //     o: pre-allocated array of at least 12 characters long for output
-// Output string will be placed in o. There is no zero patching neither on the 
-// left nor on the right of the decimal point. The decimal point is a simple 
-// character insertion in position d. Output is formatted to trim leading 
-// spaces so called left-justified. Output will have no spaces on the right. 
-// Terminate by '\0'. 
+// Output string will be placed in o, left-justified, terminated by '\0'. 
+// Zero is patched in front of the decimal point where needed ("0.05"). 
+// u32Fmt() into a plain buffer. 
 //-----------------------------------------------------------------------------
 void __section("i2a") u32_a12_d(uint32_t w, uint8_t d, char* o)
 {
-    char *u;
-    char v[11];
-    u = u32_to_a11(w);
-    insertAt(u, v, '.', d);
-    trimLeft(v, o);
-    return;
-}
-void __section("i2a") u32_a12(uint32_t w, char* o)
-{
-    char *u;
-    u = u32_to_a11(w);
-    trimLeft(u, o);
+    uint8_t f = (d < 10) ? FMT_FIX(10 - d) : FMT_DEC;
+    u32Fmt(w, f, 0, o, 0, 0xFF);
+    o[u32FmtLen(w, f, 0)] = '\0';
     return;
 }
 
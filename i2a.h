@@ -4,8 +4,8 @@
 //
 // Created on February 11, 2020, 09:01
 //-----------------------------------------------------------------------------
-// Value to text conversion utility function and associated string manipulation
-// function - attempting to be leaner than standard sprintf().
+// Value to text and text to value conversion utility functions - attempting to
+// be leaner than standard sprintf().
 //-----------------------------------------------------------------------------
 
 #ifndef I2A_H
@@ -17,42 +17,30 @@
 #include "cocoos.h"
 
 //-------------------------------------------------------------------
-// Function result in its own allocated RAM variable
-//-------------------------------------------------------------------
-char *u32_to_a11(uint32_t);
-
-//-------------------------------------------------------------------
-// Function directly modifies the operant string
-//-------------------------------------------------------------------
-void trimRight(char *a);
-
-//-------------------------------------------------------------------
-// Functions requires output operant with pre-allocated RAM
-//-------------------------------------------------------------------
-void trimLeft(char *a, char *b);
-void insertAt(char*, char*, char, uint8_t);
-
-//-------------------------------------------------------------------
-// Functions with and without decimal dot inserted in desired pos.
+// Function with decimal dot inserted in desired pos.
 //-------------------------------------------------------------------
 void u32_a12_d(uint32_t w, uint8_t d, char o[]);
-void u32_a12(uint32_t, char*);
 
 //-------------------------------------------------------------------
-// task that handles long computation jobs 
+// One-pass formatter, u32_a12_d() is a wrapper of it. Format byte f: 
+//     FMT_DEC      decimal
+//     FMT_FIX(d)   decimal, d = 1..9 digits after the decimal point
+//     FMT_HEX(n)   "0x" and the n = 1..4 least significant bytes
+// u32FmtLen() is the number of characters u32Fmt() writes at width w.
+// printu() (textTerm.c) writes the text straight into the TX ring. 
 //-------------------------------------------------------------------
-extern Evt_t u32GoEvent;
-extern Evt_t u32DoneEvent;
-extern char u32string[];
-extern uint32_t u32Operant;
-void u32Toa11_task(void);
+#define FMT_DEC         (0x00)
+#define FMT_FIX(d)      ((uint8_t)(d))
+#define FMT_HEX_F       (0x10)
+#define FMT_HEX(n)      ((uint8_t)(FMT_HEX_F | (n)))
+uint8_t u32FmtLen(uint32_t x, uint8_t f, uint8_t w);
+void u32Fmt(uint32_t x, uint8_t f, uint8_t w, char *b, uint8_t at, uint8_t mask);
 
 //-------------------------------------------------------------------
 // Hex<->text conversion function prototypes
 //-------------------------------------------------------------------
 char lowewrNibbleToAscii(uint8_t);
 uint8_t hexCharValue(char);
-char *u32_to_hex(uinteger32_t, uint8_t);
 bool hexStringtoi32(char*, uint8_t, uint32_t*);
 bool decStringtoi32(char*, uint8_t, uint32_t*);
 
@@ -0,0 +1,348 @@
+//-----------------------------------------------------------------------------
+// File:   link.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Framed console link, protocol see link.h. linkService() is run every tick
+// by textTerminal_task() while the link is active. The console print queues
+// of textTerm.c are not drained by textTermTx_ISR() in link mode, their text
+// is pulled into the retransmission window and sent in frames instead. Both
+// EUSART1 interrupt handlers are swapped for the duration: received bytes go
+// to rxRing[] (the MCC receive buffer is only 8 bytes, which is less than one
+// tick at 115200), encoded frames are sent from outRing[].
+//-----------------------------------------------------------------------------
+
+#include "link.h"
+#include "xc.h"
+#include "eusart1.h"
+#include "textTerm.h"
+#include "crc16.h"
+#include "cobs.h"
+#include "stddef.h"
+
+#define LINK_OUT_SIZE (128)         // power of 2, <= 128
+#define LINK_RX_SIZE  (64)          // power of 2, <= 128
+#define LINK_RAW_MAX  (LINK_MTU+3)  // ctl, data, crc
+#define LINK_COBS_MAX (LINK_RAW_MAX+1)
+#define LINK_SEQ      (0x07)
+
+#define LS_OFF     (0)
+#define LS_ENTER   (1)  // waiting for console text to go out in text mode
+#define LS_RUN     (2)
+#define LS_BAUD    (3)  // ACK of LINK_CTRL_BAUD going out at the old rate
+#define LS_CONFIRM (4)  // new rate set, waiting for a valid frame
+#define LS_EXIT    (5)  // ACK of LINK_CTRL_EXIT going out
+
+static uint8_t linkState = LS_OFF;
+
+#if (LINK_WINDOW & (LINK_WINDOW-1)) || (LINK_WINDOW >= 8)
+#error "LINK_WINDOW must be a power of 2 below 8"
+#endif
+
+//-----------------------------------------------------------------------------
+// SPBRGH1:SPBRG1 per LINK_BAUD_xxx. BRG16 = 1, BRGH = 1 as set up by MCC,
+// baud = FOSC / (4 * (n + 1)), FOSC = 64 MHz. Error is within 1 %.
+//-----------------------------------------------------------------------------
+static const uint16_t __section("link") linkBrg[] = {416, 277, 138, 68, 34};
+#define N_BAUDS (sizeof(linkBrg)/sizeof(linkBrg[0]))
+static uint8_t baudOld, baudNew;
+
+static uint8_t outRing[LINK_OUT_SIZE];
+static volatile uint8_t outHead, outTail;
+
+static uint8_t rxRing[LINK_RX_SIZE];
+static volatile uint8_t rxHead, rxTail;
+static uint8_t rxFrame[LINK_COBS_MAX]; // being received, decoded in place
+static uint8_t rxLen;                  // 0xFF == overlong, to be NAK-ed
+static uint8_t rxExpect;               // seq of the next in-sequence frame
+
+//-----------------------------------------------------------------------------
+// Retransmission window. Sequence numbers are free-running uint8_t, the low
+// 3 bits go on the wire: txBase <= txSend <= txNext, txBase the oldest frame
+// not acknowledged, txSend the next one to (re)send, txNext the next new one.
+//-----------------------------------------------------------------------------
+static uint8_t txWin[LINK_WINDOW][LINK_MTU];
+static uint8_t txWinLen[LINK_WINDOW];
+static uint8_t txBase, txSend, txNext;
+static uint8_t retry;
+static uint16_t ackTimer, idleTimer, confirmTimer;
+
+//-----------------------------------------------------------------------------
+// EUSART1 interrupt handlers in link mode, installed by linkHandlers()
+//-----------------------------------------------------------------------------
+static void __section("link") linkTx_ISR(void)
+{
+    if (outTail != outHead)
+    {
+        TXREG1 = outRing[outTail & (LINK_OUT_SIZE-1)];
+        ++outTail;
+        return;
+    }
+    PIE1bits.TX1IE = 0;
+    return;
+}
+
+static void __section("link") linkRx_ISR(void)
+{
+    uint8_t h = rxHead;
+    uint8_t b = RCREG1; //------- bytes with framing errors are left to CRC
+    if (RCSTA1bits.OERR) {RCSTA1bits.CREN = 0; RCSTA1bits.CREN = 1;}
+    if ((uint8_t)(h - rxTail) >= LINK_RX_SIZE) {return;}
+    rxRing[h & (LINK_RX_SIZE-1)] = b;
+    rxHead = h + 1;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Swap the EUSART1 interrupt handlers. Leftovers in the MCC receive buffer
+// are text mode input and are discarded either way.
+//-----------------------------------------------------------------------------
+static void __section("link") linkHandlers(bool on)
+{
+    while (EUSART1_is_rx_ready()) {EUSART1_Read();}
+    PIE1bits.TX1IE = 0;
+    PIE1bits.RC1IE = 0;
+    if (on)
+    {
+        outHead = outTail = 0;
+        rxHead = rxTail = 0;
+        EUSART1_SetTxInterruptHandler(linkTx_ISR);
+        EUSART1_SetRxInterruptHandler(linkRx_ISR);
+    }
+    else
+    {
+        EUSART1_SetTxInterruptHandler(textTermTx_ISR);
+        EUSART1_SetRxInterruptHandler(EUSART1_Receive_ISR);
+        PIE1bits.TX1IE = 1; //------- textTermTx_ISR() stops itself if idle
+    }
+    PIE1bits.RC1IE = 1;
+    while (EUSART1_is_rx_ready()) {EUSART1_Read();}
+    return;
+}
+
+static void __section("link") linkBaud(uint8_t b)
+{
+    SPBRGH1 = (uint8_t)(linkBrg[b] >> 8);
+    SPBRG1 = (uint8_t)(linkBrg[b] & 0xFF);
+    return;
+}
+
+static void __section("link") linkStop(void)
+{
+    linkHandlers(false);
+    linkBaud(LINK_BAUD_38400);
+    linkState = LS_OFF;
+    printc("\r\nText mode\r\n\0");
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// outFrame()
+// Input:  ctl byte, n <= LINK_MTU data bytes
+// Output: true  == frame queued to outRing[]
+//         false == not enough room, nothing is queued
+//-----------------------------------------------------------------------------
+static bool __section("link") outFrame(uint8_t ctl, const uint8_t *d, uint8_t n)
+{
+    uint8_t raw[LINK_RAW_MAX], enc[LINK_COBS_MAX+1];
+    uint8_t h = outHead;
+    if ((uint8_t)(LINK_OUT_SIZE - (uint8_t)(h - outTail)) < n + 5) {return false;}
+    raw[0] = ctl;
+    for (uint8_t i = 0; i < n; ++i) {raw[i+1] = d[i];}
+    uint16_t crc = crc16Block(raw, n+1);
+    raw[n+1] = (uint8_t)(crc & 0xFF);
+    raw[n+2] = (uint8_t)(crc >> 8);
+    n = cobsEncode(raw, n+3, enc);
+    for (uint8_t i = 0; i < n; ++i) {outRing[h++ & (LINK_OUT_SIZE-1)] = enc[i];}
+    outHead = h;
+    PIE1bits.TX1IE = 1;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// ACK or NAK from the host, e == next seq expected by the host. Stale ones
+// (e outside the window) are ignored.
+//-----------------------------------------------------------------------------
+static void __section("link") linkAck(uint8_t e, bool isNak)
+{
+    uint8_t d = (uint8_t)(e - txBase) & LINK_SEQ;
+    if (d > (uint8_t)(txNext - txBase)) {return;}
+    if (d) {txBase += d; retry = 0; ackTimer = 0;}
+    if (isNak || ((uint8_t)(txSend - txBase) > (uint8_t)(txNext - txBase)))
+    {
+        txSend = txBase;
+    }
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// One frame from the host, rxFrame[rxLen] still COBS encoded
+//-----------------------------------------------------------------------------
+static void __section("link") linkFrame(void)
+{
+    uint8_t n = (rxLen == 0xFF) ? 0 : cobsDecode(rxFrame, rxLen, rxFrame);
+    uint16_t crc = (n >= 3) ? crc16Block(rxFrame, n-2) : 0;
+    if ((n < 3) || ((uint8_t)(crc & 0xFF) != rxFrame[n-2])
+     || ((uint8_t)(crc >> 8) != rxFrame[n-1]))
+    {
+        outFrame(LINK_NAK | (rxExpect & LINK_SEQ), NULL, 0);
+        return;
+    }
+
+    //------------------------------------------------------------ valid
+    uint8_t ctl = rxFrame[0];
+    n -= 3;
+    idleTimer = 0;
+    if (linkState == LS_CONFIRM) {baudOld = baudNew; linkState = LS_RUN;}
+    switch (ctl & 0xF0)
+    {
+        case LINK_ACK: linkAck(ctl & LINK_SEQ, false); return;
+        case LINK_NAK: linkAck(ctl & LINK_SEQ, true);  return;
+        case LINK_DATA:
+        case LINK_CTRL: break;
+        default: return;
+    }
+    if ((ctl & LINK_SEQ) != (rxExpect & LINK_SEQ))
+    {
+        outFrame(LINK_ACK | (rxExpect & LINK_SEQ), NULL, 0);
+        return;
+    }
+    ++rxExpect;
+    outFrame(LINK_ACK | (rxExpect & LINK_SEQ), NULL, 0);
+
+    if ((ctl & 0xF0) == LINK_DATA)
+    {
+        textTermLine((char*)&rxFrame[1], n);
+    }
+    else if ((n >= 1) && (rxFrame[1] == LINK_CTRL_EXIT))
+    {
+        linkState = LS_EXIT;
+    }
+    else if ((n >= 2) && (rxFrame[1] == LINK_CTRL_BAUD)
+          && (rxFrame[2] < N_BAUDS) && (linkState == LS_RUN))
+    {
+        baudNew = rxFrame[2];
+        linkState = LS_BAUD;
+    }
+    else
+    {
+        printc("\r\nInvalid Value\r\n\0");
+    }
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// The "link" command. The switch happens in linkService() once the reply and
+// the prompt have gone out as text.
+//-----------------------------------------------------------------------------
+void __section("link") linkStart(void)
+{
+    if (linkState == LS_OFF) {linkState = LS_ENTER;}
+    return;
+}
+
+bool __section("link") linkActive(void)
+{
+    return (linkState != LS_OFF);
+}
+
+//-----------------------------------------------------------------------------
+// linkService()
+// Called once per tick (1 ms) by textTerminal_task() while linkActive().
+//-----------------------------------------------------------------------------
+void __section("link") linkService(void)
+{
+    switch (linkState)
+    {
+        case LS_ENTER:
+            if (!textTermTxIdle()) {return;}
+            linkHandlers(true);
+            txBase = txSend = txNext = 0;
+            rxExpect = 0;
+            rxLen = 0;
+            retry = 0;
+            ackTimer = idleTimer = 0;
+            baudOld = baudNew = LINK_BAUD_38400;
+            linkState = LS_RUN;
+            return;
+        case LS_BAUD:
+        case LS_EXIT:
+            if ((outTail != outHead) || !TXSTA1bits.TRMT) {break;}
+            if (linkState == LS_EXIT) {linkStop(); return;}
+            linkBaud(baudNew);
+            confirmTimer = 0;
+            linkState = LS_CONFIRM;
+            break;
+        case LS_CONFIRM:
+            if (++confirmTimer < LINK_CONFIRM_MS) {break;}
+            linkBaud(baudOld); //------------ host did not follow, go back
+            baudNew = baudOld;
+            linkState = LS_RUN;
+            break;
+        default:
+            break;
+    }
+
+    //--------------------------------------------------------------------
+    // Receive
+    //--------------------------------------------------------------------
+    while (rxTail != rxHead)
+    {
+        uint8_t b = rxRing[rxTail & (LINK_RX_SIZE-1)];
+        ++rxTail;
+        if (b == 0)
+        {
+            if (rxLen) {linkFrame();}
+            rxLen = 0;
+        }
+        else if (rxLen < LINK_COBS_MAX) {rxFrame[rxLen++] = b;}
+        else {rxLen = 0xFF;}
+    }
+    if (++idleTimer >= LINK_IDLE_MS) {linkStop(); return;}
+    if (linkState != LS_RUN) {return;}
+
+    //--------------------------------------------------------------------
+    // Transmit: retransmission timeout, fill the window with console text,
+    // send what has not been sent
+    //--------------------------------------------------------------------
+    if (txBase == txNext) {ackTimer = 0;}
+    else if (++ackTimer >= LINK_ACK_MS)
+    {
+        ackTimer = 0;
+        txSend = txBase;
+        if (++retry > LINK_RETRY_MAX) {linkStop(); return;}
+    }
+    while ((uint8_t)(txNext - txBase) < LINK_WINDOW)
+    {
+        uint8_t k = txNext & (LINK_WINDOW-1);
+        txWinLen[k] = textTermTxPull(txWin[k], LINK_MTU);
+        if (txWinLen[k] == 0) {break;}
+        ++txNext;
+    }
+    while (txSend != txNext)
+    {
+        uint8_t k = txSend & (LINK_WINDOW-1);
+        if (!outFrame(LINK_DATA | (txSend & LINK_SEQ), txWin[k], txWinLen[k]))
+        {
+            break;
+        }
+        ++txSend;
+    }
+    return;
+}
+
+#undef N_BAUDS
+#undef LS_EXIT
+#undef LS_CONFIRM
+#undef LS_BAUD
+#undef LS_RUN
+#undef LS_ENTER
+#undef LS_OFF
+#undef LINK_SEQ
+#undef LINK_COBS_MAX
+#undef LINK_RAW_MAX
+#undef LINK_RX_SIZE
+#undef LINK_OUT_SIZE
+
+//----------------------------------------------------------------- end of file
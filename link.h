@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+// File:   link.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Framed console link for machine clients ("link" command). The console keeps
+// working as before: command lines go in, the same text comes out, but both
+// directions are carried in CRC-16 protected frames with go-back-N
+// retransmission, so that the baud rate can be raised on cables where raw
+// text at 115200 sees bit errors.
+//-----------------------------------------------------------------------------
+// Frame on the wire: COBS(ctl, data[0..LINK_MTU], crc lo, crc hi) then 0x00.
+// crc is crc16Block() of ctl and data.
+//     ctl bits 7..4 type, bits 2..0 seq
+//     LINK_DATA  data = console text (device to host) or one command line
+//                without CR/LF (host to device). seq counts DATA and CTRL
+//                frames of the sender modulo 8, at most LINK_WINDOW frames
+//                are sent ahead of the oldest unacknowledged one.
+//     LINK_CTRL  data[0] = LINK_CTRL_EXIT: back to text mode at 38400
+//                data[0] = LINK_CTRL_BAUD, data[1] = LINK_BAUD_xxx
+//                Host to device only, sequenced like DATA.
+//     LINK_ACK   no data, seq = next seq expected by the sender of the ACK.
+//                Acknowledges all frames before seq.
+//     LINK_NAK   as LINK_ACK, and asks for all frames from seq to be sent
+//                again. Sent for a frame failing COBS, length or CRC checks.
+// A frame received in sequence is answered by an ACK, out of sequence (a
+// duplicate or after a lost one) by an ACK for the expected seq and dropped.
+//-----------------------------------------------------------------------------
+// Entering: type "link" in text mode, wait for the prompt, then send frames,
+// both sides starting at seq 0.
+// Baud change: send LINK_CTRL_BAUD, on its ACK (at the old rate) switch the
+// host port and send any valid frame, e.g. an ACK, within LINK_CONFIRM_MS.
+// Otherwise the device goes back to the old rate.
+// Fall back: the device returns to text mode at 38400 when a frame is sent
+// LINK_RETRY_MAX times without ACK, or nothing valid is received for
+// LINK_IDLE_MS. An idle client sends an ACK now and then as keep-alive.
+//-----------------------------------------------------------------------------
+
+#ifndef LINK_H
+#define	LINK_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define LINK_MTU        (32)    // data bytes per frame
+#define LINK_WINDOW     (4)     // frames in flight, power of 2, < 8
+#define LINK_ACK_MS     (100)   // retransmission timeout
+#define LINK_RETRY_MAX  (10)
+#define LINK_CONFIRM_MS (1000)
+#define LINK_IDLE_MS    (30000)
+
+#define LINK_DATA       (0x00)
+#define LINK_ACK        (0x10)
+#define LINK_NAK        (0x20)
+#define LINK_CTRL       (0x30)
+
+#define LINK_CTRL_EXIT  (0)
+#define LINK_CTRL_BAUD  (1)
+
+#define LINK_BAUD_38400  (0)
+#define LINK_BAUD_57600  (1)
+#define LINK_BAUD_115200 (2)
+#define LINK_BAUD_230400 (3)
+#define LINK_BAUD_460800 (4)
+
+void linkStart(void);
+bool linkActive(void);
+void linkService(void);
+
+#endif	/* LINK_H */
+
+//----------------------------------------------------------------- end of file
@@ -23,6 +23,12 @@
 #include "i2a.h"
 #include "alarm.h"
 #include "opParam.h"
+#include "analogOut.h"
+#include "telemetry.h"
+#include "csvLog.h"
+#include "rtc.h"
+#include "eeQueue.h"
+#include "oscCal.h"
 
 //-----------------------------------------------------------------------------
 // Debug notes: ICD reset usually occurs multiple times in succession.11Feb2020
@@ -35,6 +41,12 @@ void main(void)
     // progressing towards highest level (application). 
     //-------------------------------------------------------------------------
     SYSTEM_Initialize(); //----------- MCC Microchip Code Configurator
+#if OC1_REPEATER
+    ocRepeaterInitialize(); //------------- TMR3 + CCP1 compare drive OC1
+#endif
+    aoutInitialize(); //------------- EPWM2 as analog output if AOUT_ENABLE
+    eeInitialize(); //------------------- EEIF completes queued EEPROM writes
+    rtcInitialize(); //----------------- TMR5 time base of stamps and time()
     
     //-------------------------------------------------------------------------
     // Advanced high-low interrupt is used (configured in MCC from which source
@@ -42,7 +54,10 @@ void main(void)
     // manually in-lined to the respective ISR to minimize latency of time-
     // critical interrupt(s).
     //-------------------------------------------------------------------------
+#if !OS_DEFERRED_TICK
     TMR0_SetInterruptHandler(os_tick);       //------ Allocate timer to OS tick
+#endif
+    EUSART1_SetTxInterruptHandler(textTermTx_ISR); //--- console TX drain
     //TMR3_SetInterruptHandler(adcTmr3Hanlder);
     //TMR5_SetInterruptHandler(adcTmr5Hanlder);
     //ADC_SetInterruptHandler(adcDataHandler);
@@ -70,25 +85,22 @@ void main(void)
     //         apply.
     // Tests the above if not observed the MCU will hang.
     //-------------------------------------------------------------------------
-    u32GoEvent = event_create();
-    u32DoneEvent = event_create();
+    avEvent = event_create();
     
     //task_create( adc_task,            NULL, 127, NULL, 0, 0 );
-    task_create( u32Toa11_task,       NULL, 126, NULL, 0, 0 );
     task_create( av_control_task,     NULL, 128, NULL, 0, 0 );
     task_create( alarm_task,          NULL, 125, NULL, 0, 0 );
-    task_create( print_task,          NULL, 129, NULL, 0, 0 );
     task_create( senseTrigger_task,   NULL, 131, NULL, 0, 0 );
     task_create( textTerminal_task,   NULL, 130, NULL, 0, 0 );
     task_create( realTimeReport_task, NULL, 127, NULL, 0, 0 );
+    task_create( telemetry_task,      NULL, 129, NULL, 0, 0 );
+    task_create( csvLog_task,         NULL, 132, NULL, 0, 0 );
     
     //-------------------------------------------------------------------------
     // Load operating metrics from EEPROM
     //-------------------------------------------------------------------------
-    opSetPre_AlarmFromEE();
-    opSetMainAlarmFromEE();
-    opSetAlarmSamplingFromEE();
-    opSetCmpVoltThresholdFromEE();
+    oscLoadFromEE();
+    opLoadFromEE();
         
     //-------------------------------------------------------------------------
     // If using interrupts in PIC18 High/Low Priority Mode, enable the Global 
@@ -97,6 +109,11 @@ void main(void)
     INTERRUPT_GlobalInterruptHighEnable();
     INTERRUPT_GlobalInterruptLowEnable();
     
+    //-------------------------------------------------------------------------
+    // EEPROM writes complete from the EEIF interrupt, so they come after
+    //-------------------------------------------------------------------------
+    opSaveUpgraded();
+    
     //-------------------------------------------------------------------------
     // If using interrupts in PIC Mid-Range Compatibility Mode, enable the 
     // Global and Peripheral Interrupts (not our use case, commented out and 
@@ -48,6 +48,10 @@
 
 #include "interrupt_manager.h"
 #include "mcc.h"
+#include "../edgeDetect.h"
+#include "../eeQueue.h"
+#include "../rtc.h"
+#include "cocoos.h"
 
 void  INTERRUPT_Initialize (void)
 {
@@ -68,6 +72,14 @@ void  INTERRUPT_Initialize (void)
     // CI - high priority
     IPR2bits.C1IP = 1;
 
+#if OC1_REPEATER
+    // CCPI - high priority (OC1 pulse repeater, edgeDetect.c)
+    IPR1bits.CCP1IP = 1;
+#endif
+
+    // TMR5I - high priority (RTC time base, rtc.c)
+    IPR5bits.TMR5IP = 1;
+
 
     // TXI - low priority
     IPR1bits.TX1IP = 0;    
@@ -88,7 +100,14 @@ void __interrupt() INTERRUPT_InterruptManagerHigh (void)
    // interrupt handler
     if(INTCONbits.TMR0IE == 1 && INTCONbits.TMR0IF == 1)
     {
+#if OS_DEFERRED_TICK
+        // 1 ms OS tick, counted only; the scheduler loop does the rest
+        INTCONbits.TMR0IF = 0;
+        TMR0L = timer0ReloadVal;
+        os_tick_ISR();
+#else
         TMR0_ISR();
+#endif
     }
     if(PIE1bits.TMR1IE == 1 && PIR1bits.TMR1IF == 1)
     {
@@ -102,6 +121,16 @@ void __interrupt() INTERRUPT_InterruptManagerHigh (void)
     {
         CMP1_ISR();
     }
+#if OC1_REPEATER
+    if(PIE1bits.CCP1IE == 1 && PIR1bits.CCP1IF == 1)
+    {
+        CCP1_ISR();
+    }
+#endif
+    if(PIE5bits.TMR5IE == 1 && PIR5bits.TMR5IF == 1)
+    {
+        rtcTmr5_ISR();
+    }
 }
 
 void __interrupt(low_priority) INTERRUPT_InterruptManagerLow (void)
@@ -115,6 +144,10 @@ void __interrupt(low_priority) INTERRUPT_InterruptManagerLow (void)
     {
         EUSART1_RxDefaultInterruptHandler();
     }
+    if(PIE2bits.EEIE == 1 && PIR2bits.EEIF == 1)
+    {
+        eeWrite_ISR();
+    }
     if(PIE2bits.BCL1IE == 1 && PIR2bits.BCL1IF == 1)
     {
         MSSP1_InterruptHandler();
@@ -66,7 +66,9 @@
   Section: Macro Declarations
 */
 
-#define TMR0_INTERRUPT_TICKER_FACTOR    4
+#define TMR0_INTERRUPT_TICKER_FACTOR    1
+
+extern volatile uint8_t timer0ReloadVal;
 
 /**
   Section: TMR0 APIs
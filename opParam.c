@@ -10,10 +10,15 @@
 #include "memory.h"
 #include "edgeDetect.h"
 #include "alarm.h"
+#include "analogOut.h"
+#include "eeQueue.h"
+#include "stdbool.h"
 
 //-----------------------------------------------------------------------------
 // Compiler directives (XC8) to initialize EEPROM upon programming. Use this
 // mechanism to pre-configure the chip for specific application/customer.
+// These are in the legacy layout (opParam.h), copied into the parameter 
+// block on first boot. 
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
@@ -24,13 +29,148 @@ __EEPROM_DATA(0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00);
 //-----------------------------------------------------------------------------
 // 0x32 == dec 50 x 10ms sampling interval, DAC control byte is left-shifted 3
 // bits, 0x10>>3 == 0x02 corresponds to 2.75 volts Hi-Lo threshold. 
+// Analog output 0 Hz == 0 V, 0x03E8 == 1000 Hz == 5 V. 
 //-----------------------------------------------------------------------------
-__EEPROM_DATA(0x32,0x10,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF);
+__EEPROM_DATA(0x32,0x10,0x00,0x00,0xE8,0x03,0xFF,0xFF);
+
+//-----------------------------------------------------------------------------
+// RAM images of all profiles, loaded once at boot, so that a profile switch
+// does not read the EEPROM. op points at the active one, which is always 
+// equal to the parameters in use. 
+//-----------------------------------------------------------------------------
+static opBlock_t opProf[OP_PROFILES];
+static opBlock_t *op = &opProf[0];
+static uint8_t opSel = 0;
+static uint8_t opUnsaved = 0;       // bit p: no OP_VERSION record of profile p
+
+#if OP_PROFILES != 4
+#error "opRing[] initializer is written for 4 profiles"
+#endif
+#define OP_RING(p) EE_RING(EA_OPRING + (p) * OP_RING_SPAN, \
+                           sizeof(opBlock_t), OP_SLOTS)
+eeRing_t opRing[OP_PROFILES] = {OP_RING(0), OP_RING(1), OP_RING(2), OP_RING(3)};
+static eeRing_t opSelRing = EE_RING(EA_OPSEL, sizeof(opSel), OP_SLOTS);
+EE_SLOT_CHECK(opBlockSlotFits, sizeof(opBlock_t));
+EE_SLOT_CHECK(opSelSlotFits, sizeof(opSel));
+
+//-----------------------------------------------------------------------------
+// opSave() : *op to the next slot of the active profile's ring. The writes 
+// are queued (eeQueue.c), this returns at once unless the queue is full. 
+//-----------------------------------------------------------------------------
+static bool __section("opParam") opSave(void)
+{
+    if (!eeRingSave(&opRing[opSel], op)) {return false;}
+    opUnsaved &= (uint8_t)~(1 << opSel);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// opApply() : make *op the parameters in use. Called from task context, the 
+// alarm task hence never sees half a profile. The copies read by the ISRs 
+// are updated with their interrupts suspended (alarmLevelUpdate(), 
+// aoutSetScale()). 
+//-----------------------------------------------------------------------------
+static void __section("opParam") opApply(void)
+{
+    pAlarmLevel = op->pAlarm;
+    mAlarmLevel = op->mAlarm;
+    alarmLevelUpdate();
+    sampleInterval = op->sample;
+    VREFCON2 = (op->cmpVth >> 3);
+    aoutSetScale(op->aoutZero, op->aoutFull);
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// opLoadFromEE() : called once at boot. Each profile is loaded from the 
+// newest valid record of its ring. Without one profile 0 is taken from the 
+// legacy per-field layout (defaults or upgraded firmware), saved later by 
+// opSaveUpgraded(). Other profiles without one start as a copy of profile 
+// 0, saved when first selected. A ring keeps the gen eeRingLoad() found even
+// when its record is of another OP_VERSION, so that the next save outranks
+// the stale slots. The selected profile is applied. Nothing is written here: interrupts are still off, a queued write would 
+// never complete and the next eeRead() would wait for it forever. 
+//-----------------------------------------------------------------------------
+void __section("opParam") opLoadFromEE(void)
+{
+    if (!eeRingLoad(&opRing[0], op) || (op->version != OP_VERSION))
+    {
+        uinteger32_t x;
+        opUnsaved = 1;
+        op->version = OP_VERSION;
+        x.bytes.C0 = DATAEE_ReadByte(EA_PALARM+0);
+        x.bytes.C1 = DATAEE_ReadByte(EA_PALARM+1);
+        x.bytes.C2 = DATAEE_ReadByte(EA_PALARM+2);
+        x.bytes.C3 = DATAEE_ReadByte(EA_PALARM+3);
+        op->pAlarm = x.value;
+        x.bytes.C0 = DATAEE_ReadByte(EA_MALARM+0);
+        x.bytes.C1 = DATAEE_ReadByte(EA_MALARM+1);
+        x.bytes.C2 = DATAEE_ReadByte(EA_MALARM+2);
+        x.bytes.C3 = DATAEE_ReadByte(EA_MALARM+3);
+        op->mAlarm = x.value;
+        op->sample = DATAEE_ReadByte(EA_SAMPLE);
+        op->cmpVth = DATAEE_ReadByte(EA_CMPVTH);
+        op->aoutZero = DATAEE_ReadByte(EA_AOUTZ+0) 
+            | ((uint16_t)DATAEE_ReadByte(EA_AOUTZ+1) << 8);
+        op->aoutFull = DATAEE_ReadByte(EA_AOUTF+0) 
+            | ((uint16_t)DATAEE_ReadByte(EA_AOUTF+1) << 8);
+    }
+    for (uint8_t p = 1; p < OP_PROFILES; ++p)
+    {
+        if (!eeRingLoad(&opRing[p], &opProf[p]) 
+         || (opProf[p].version != OP_VERSION))
+        {
+            opProf[p] = opProf[0];
+            opUnsaved |= (uint8_t)(1 << p);
+        }
+    }
+    if (!eeRingLoad(&opSelRing, &opSel) || (opSel >= OP_PROFILES)) 
+    {
+        opSel = 0;
+    }
+    op = &opProf[opSel];
+    opApply();
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// opSaveUpgraded() : called once at boot after the interrupts are enabled. 
+// Saves profile 0 if opLoadFromEE() took it from the legacy layout, so that
+// this happens only once. 
+//-----------------------------------------------------------------------------
+void __section("opParam") opSaveUpgraded(void)
+{
+    if (!(opUnsaved & 1)) {return;}
+    if (eeRingSave(&opRing[0], &opProf[0])) {opUnsaved &= (uint8_t)~1;}
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// opSelectProfile() : make profile p the parameters in use and remember it 
+// across reset. Takes effect at once, from the RAM image. 
+// Output: false == p is out of range, nothing is changed
+//-----------------------------------------------------------------------------
+bool __section("opParam") opSelectProfile(uint8_t p)
+{
+    if (p >= OP_PROFILES) {return false;}
+    if (p == opSel) {return true;}
+    opSel = p;
+    op = &opProf[p];
+    opApply();
+    if (opUnsaved & (1 << p)) {opSave();}
+    eeRingSave(&opSelRing, &opSel);
+    return true;
+}
+
+uint8_t __section("opParam") opGetProfile(void)
+{
+    return opSel;
+}
 
 //-----------------------------------------------------------------------------
 // Functions that take a snapshot sample of the current pulse period and apply
 // it to alarm (setting the alarm threshold) at the same time updating internal
-// parameter EEPROM. 
+// parameter EEPROM. A value equal to the one in use is not saved again. 
 //-----------------------------------------------------------------------------
 void __section("opParam") opSetPre_AlarmFromCapture(void)
 {
@@ -44,83 +184,67 @@ void __section("opParam") opSetMainAlarmFromCapture(void)
 }
 void __section("opParam") opSetPre_AlarmByValue(uint32_t x)
 {
-    pAlarmLevel = x;
-    DATAEE_WriteByte(EA_PALARM+0, x & 0xFF);
-    DATAEE_WriteByte(EA_PALARM+1, (x >> 8) & 0xFF);
-    DATAEE_WriteByte(EA_PALARM+2, (x >> 16) & 0xFF);
-    DATAEE_WriteByte(EA_PALARM+3, (x >> 24) & 0xFF);
-    //---------------------------------------------------------------
-    // Read-back check is not implemented due to yet-to-be-determined
-    // what to do if fail, such as marking an alternative address and
-    // write there instead.
-    //---------------------------------------------------------------
+    if (op->pAlarm == x) {return;}
+    pAlarmLevel = op->pAlarm = x;
+    alarmLevelUpdate();
+    opSave();
     return;
 }
 void __section("opParam") opSetMainAlarmByValue(uint32_t x)
 {
-    mAlarmLevel = x;
-    DATAEE_WriteByte(EA_MALARM+0, x & 0xFF);
-    DATAEE_WriteByte(EA_MALARM+1, (x >> 8) & 0xFF);
-    DATAEE_WriteByte(EA_MALARM+2, (x >> 16) & 0xFF);
-    DATAEE_WriteByte(EA_MALARM+3, (x >> 24) & 0xFF);
+    if (op->mAlarm == x) {return;}
+    mAlarmLevel = op->mAlarm = x;
+    alarmLevelUpdate();
+    opSave();
     return;
 }
 void __section("opParam") opZeroAllAlarmLevels(void)
 {
-    opSetPre_AlarmByValue(0);
-    opSetMainAlarmByValue(0);
-    return;
-}
-
-//-----------------------------------------------------------------------------
-// Functions that load operational parameters from internal EEPROM.
-//-----------------------------------------------------------------------------
-void __section("opParam") opSetPre_AlarmFromEE(void)
-{
-    uinteger32_t x;
-    x.bytes.C0 = DATAEE_ReadByte(EA_PALARM+0);
-    x.bytes.C1 = DATAEE_ReadByte(EA_PALARM+1);
-    x.bytes.C2 = DATAEE_ReadByte(EA_PALARM+2);
-    x.bytes.C3 = DATAEE_ReadByte(EA_PALARM+3);
-    pAlarmLevel = x.value;
-    return;
-}
-void __section("opParam") opSetMainAlarmFromEE(void)
-{
-    uinteger32_t x;
-    x.bytes.C0 = DATAEE_ReadByte(EA_MALARM+0);
-    x.bytes.C1 = DATAEE_ReadByte(EA_MALARM+1);
-    x.bytes.C2 = DATAEE_ReadByte(EA_MALARM+2);
-    x.bytes.C3 = DATAEE_ReadByte(EA_MALARM+3);
-    mAlarmLevel = x.value;
+    if (!op->pAlarm && !op->mAlarm) {return;}
+    pAlarmLevel = op->pAlarm = 0;
+    mAlarmLevel = op->mAlarm = 0;
+    alarmLevelUpdate();
+    opSave();
     return;
 }
 
 void __section("opParam") opSetAlarmSamplingInterval(uint8_t x)
 {
-    DATAEE_WriteByte(EA_SAMPLE, sampleInterval = x);
+    if (op->sample == x) {return;}
+    sampleInterval = op->sample = x;
+    opSave();
     return;
 };
 
-void __section("opParam") opSetAlarmSamplingFromEE(void)
+void __section("opParam") opSetCmpVoltThresholdByValue(uint8_t x)
 {
-    sampleInterval = DATAEE_ReadByte(EA_SAMPLE);
+    if (op->cmpVth == x) {return;}
+    op->cmpVth = x;
+    VREFCON2 = (x >> 3);
+    opSave();
     return;
 };
 
-void __section("opParam") opSetCmpVoltThresholdByValue(uint8_t x)
+void __section("opParam") opSetAnalogZeroByValue(uint16_t x)
 {
-    VREFCON2 = (x >> 3);
-    DATAEE_WriteByte(EA_CMPVTH, x);
+    if (op->aoutZero == x) {return;}
+    op->aoutZero = x;
+    aoutSetScale(x, aoutFullHz);
+    opSave();
     return;
 };
 
-void __section("opParam") opSetCmpVoltThresholdFromEE(void)
+void __section("opParam") opSetAnalogFullByValue(uint16_t x)
 {
-    VREFCON2 = (DATAEE_ReadByte(EA_CMPVTH) >> 3);
+    if (op->aoutFull == x) {return;}
+    op->aoutFull = x;
+    aoutSetScale(aoutZeroHz, x);
+    opSave();
     return;
 };
 
+#undef OP_RING
+
 //void __section("s_name") name_of__task(void)
 //{
 //    task_open();
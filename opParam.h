@@ -15,7 +15,9 @@
 #define	OPPARAM_H
 
 #include "stdint.h"
+#include "stdbool.h"
 #include "uintegers2.h"
+#include "eeStore.h"
 
 //-----------------------------------------------------------------------------         
 // Logging such as overspeed will ideally have date-time stamp which will need
@@ -27,7 +29,8 @@
 
 //-----------------------------------------------------------------------------
 // DATAEE_WriteByte() 
-//     It will not return until a write has completed. 
+//     It will not return until a write has completed. Not used, writes are
+//     queued to eeQueue.c instead. 
 // DATAEE_ReadByte() 
 //     "Non-blocking since it does not have to wait for EEPROM to complete the
 //     operation. Reading from EEPROM is fairly straight forward.
@@ -35,23 +38,66 @@
 // EEPROM map: Internal on-chip EEPROM is allocated as the #define below which
 //     denotes the starting addresses of each allocation block.
 //-----------------------------------------------------------------------------
+// EA_PALARM..EA_AOUTF is the per-field layout of earlier firmware, holding 
+// the factory defaults (__EEPROM_DATA in opParam.c). It is only read when 
+// profile 0 holds no valid parameter block: first boot after programming or 
+// after an upgrade from earlier firmware. 
+//-----------------------------------------------------------------------------
 #define EA_PALARM (0)
 #define EA_MALARM (EA_PALARM+4)
 #define EA_SAMPLE (EA_MALARM+4) 
 #define EA_CMPVTH (EA_SAMPLE+1)
-#define EA_NEXT   (EA_CMPVTH+1)
+#define EA_AOUTZ  (EA_CMPVTH+1)
+#define EA_AOUTF  (EA_AOUTZ+2)
+#define EA_OPRING (0x20)
+#define EA_OPSEL  (EA_OPRING+OP_PROFILES*OP_RING_SPAN)
+#define EA_OSCAL  (EA_OPSEL+EE_RING_SPAN(1, OP_SLOTS))
+#define EA_NEXT   (EA_OSCAL+EE_RING_SPAN(2, OP_SLOTS))
+
+//-----------------------------------------------------------------------------
+// Parameter block, stored in a ring of OP_SLOTS slots (eeStore.h). Each 
+// change goes to the slot after the newest one, spreading the wear over the
+// ring. A write cut short by power loss leaves a slot failing its CRC, the 
+// newest complete one still holds the previous parameters. Bump OP_VERSION
+// when the layout changes, blocks of another version are not loaded. 
+//-----------------------------------------------------------------------------
+// Profiles: OP_PROFILES complete parameter blocks, one ring each, for boxes
+// moved between vehicle types. One is in use at a time ("prof <n>"), its 
+// number is kept in a ring of its own at EA_OPSEL. Profile 0 is the ring 
+// of earlier firmware with a single block. 
+//-----------------------------------------------------------------------------
+#define OP_VERSION  (2)
+#define OP_SLOTS    (4)
+#define OP_PROFILES (4)
+#define OP_RING_SPAN EE_RING_SPAN(sizeof(opBlock_t), OP_SLOTS)
+
+typedef struct
+{
+    uint8_t  version;
+    uint32_t pAlarm;        // pAlarmLevel
+    uint32_t mAlarm;        // mAlarmLevel
+    uint8_t  sample;        // sampleInterval
+    uint8_t  cmpVth;        // DAC control byte, VREFCON2 = cmpVth >> 3
+    uint16_t aoutZero;      // aoutZeroHz
+    uint16_t aoutFull;      // aoutFullHz
+}
+opBlock_t;
+
+extern eeRing_t opRing[OP_PROFILES];
 
+void opLoadFromEE(void);
+void opSaveUpgraded(void);
+bool opSelectProfile(uint8_t);
+uint8_t opGetProfile(void);
 void opSetPre_AlarmByValue(uint32_t);
 void opSetPre_AlarmFromCapture(void);
 void opSetMainAlarmByValue(uint32_t);
 void opSetMainAlarmFromCapture(void);
 void opZeroAllAlarmLevels(void);
-void opSetPre_AlarmFromEE(void);
-void opSetMainAlarmFromEE(void);
 void opSetAlarmSamplingInterval(uint8_t);
-void opSetAlarmSamplingFromEE(void);
 void opSetCmpVoltThresholdByValue(uint8_t);
-void opSetCmpVoltThresholdFromEE(void);
+void opSetAnalogZeroByValue(uint16_t);
+void opSetAnalogFullByValue(uint16_t);
 
 #endif	/* OPPARAM_H */
 
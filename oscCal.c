@@ -0,0 +1,206 @@
+//-----------------------------------------------------------------------------
+// File:   oscCal.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Oscillator calibration against a reference pulse, see oscCal.h.
+//-----------------------------------------------------------------------------
+
+#include "xc.h"
+#include "oscCal.h"
+#include "opParam.h"
+#include "eeStore.h"
+#include "edgeDetect.h"
+#include "analogOut.h"
+#include "rtc.h"
+#include "recip.h"
+#include "textTerm.h"
+#include "helpText.h"
+#include "i2a.h"
+#include "uintegers2.h"
+
+//-----------------------------------------------------------------------------
+// The sum of OSC_CAL_N periods of the reference, times its frequency, is
+// OSC_CAL_TOTAL ticks at 0 ppm. One ppm is OSC_CAL_TOTAL / 1e6 of it.
+//-----------------------------------------------------------------------------
+#define OSC_CAL_TOTAL (RECIP_TICK_HZ * OSC_CAL_N)
+#define OSC_CAL_PPM   (OSC_CAL_TOTAL / 1000000UL)
+#if (OSC_CAL_N & (OSC_CAL_N - 1)) || (OSC_CAL_TOTAL % 1000000UL) \
+    || (OSC_CAL_TOTAL > 2000000000UL)
+#error "OSC_CAL_N: power of 2, sum x Hz must stay well below 2^31"
+#endif
+
+int16_t oscPpm = 0;
+static bool oscFast;        // sign of oscPpm
+static uint16_t oscE;       // |oscPpm| / (1e6 + oscPpm) in Q16
+
+static eeRing_t oscRing = EE_RING(EA_OSCAL, sizeof(oscPpm), OP_SLOTS);
+EE_SLOT_CHECK(oscPpmSlotFits, sizeof(int16_t));
+
+static uint16_t calHz;      // 0 == no measurement running
+static uint8_t calN;
+static uint16_t calIdle;
+static uint16_t calLast;    // capStamp low word of the last capture taken
+static uint32_t calSum, calMin, calMax;
+
+//-----------------------------------------------------------------------------
+// oscSet() : make ppm the calibration in use. Divisions are done here, once,
+// so that the conversions are multiply and shift.
+//-----------------------------------------------------------------------------
+static void __section("oscCal") oscSet(int16_t ppm)
+{
+    uint32_t a;
+    oscPpm = ppm;
+    oscFast = (ppm > 0);
+    a = oscFast ? (uint32_t)ppm : (uint32_t)(-(int32_t)ppm);
+    oscE = (uint16_t)(((a << 16) + (1000000L + ppm) / 2) / (1000000L + ppm));
+    rtcSetTrim(ppm);
+    aoutSetScale(aoutZeroHz, aoutFullHz);
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// oscLoadFromEE() : called once at boot, before opLoadFromEE(). Without a
+// valid record the oscillator is taken as exact.
+//-----------------------------------------------------------------------------
+void __section("oscCal") oscLoadFromEE(void)
+{
+    int16_t ppm;
+    if (!eeRingLoad(&oscRing, &ppm)
+     || (ppm > OSC_PPM_MAX) || (ppm < -OSC_PPM_MAX)) {ppm = 0;}
+    oscSet(ppm);
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// oscNominal() : t TMR1 ticks to nominal 16 MHz ticks, t / (1 + ppm/1e6)
+// == t -/+ t x oscE. Within 16 ppm plus 8 ticks, t < 2^24.
+//-----------------------------------------------------------------------------
+uint32_t __section("oscCal") oscNominal(uint32_t t)
+{
+    uint32_t c = ((t >> 8) * oscE) >> 8;
+    return oscFast ? t - c : t + c;
+}
+
+//-----------------------------------------------------------------------------
+// Low word of capStamp, enough to tell captures apart. The TMR1 gate 
+// interrupt is off in "sparse edge mode", restore it to whatever it was.
+//-----------------------------------------------------------------------------
+static uint16_t __section("oscCal") oscCapStamp(void)
+{
+    uint16_t s;
+    uint8_t ie = PIE3bits.TMR1GIE;
+    PIE3bits.TMR1GIE = 0;
+    s = capStamp.words.W0;
+    PIE3bits.TMR1GIE = ie;
+    return s;
+}
+
+static void __section("oscCal") printPpm(int16_t p)
+{
+    if (p < 0) {printb('-'); p = -p;} else {printb('+');}
+    printu((uint16_t)p, FMT_DEC, 0);
+    printc(" ppm\r\n\0");
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// oscCalStart() : hz == 0 clears the calibration, else a measurement of a
+// reference at hz (OSC_CAL_HZ_MIN..OSC_CAL_HZ_MAX) is started.
+//-----------------------------------------------------------------------------
+void __section("oscCal") oscCalStart(uint16_t hz)
+{
+    if (!hz)
+    {
+        oscSet(0);
+        eeRingSave(&oscRing, &oscPpm);
+        printc("\r\nOscillator \0");
+        printPpm(oscPpm);
+        return;
+    }
+    calHz = hz;
+    calN = 0;
+    calIdle = 0;
+    calSum = calMax = 0;
+    calMin = UINT32_MAX;
+    calLast = oscCapStamp();
+    printc("\r\nMeasuring reference\r\n\0");
+    return;
+}
+
+bool __section("oscCal") oscCalActive(void)
+{
+    return (calHz != 0);
+}
+
+//-----------------------------------------------------------------------------
+// oscCalService() : every tick while active. Takes each new capture once
+// (capStamp has moved), period first so that a capture in between is
+// skipped rather than counted twice.
+//-----------------------------------------------------------------------------
+void __section("oscCal") oscCalService(void)
+{
+    uint32_t t;
+    uint16_t s;
+    if (!calHz) {return;}
+
+    t = getPulsePeriod24();
+    s = oscCapStamp();
+    if ((s == calLast) || (t >= 0x00FF0000))
+    {
+        if (++calIdle < OSC_CAL_IDLE) {return;}
+        printc("No reference pulse\r\n\0");
+        calHz = 0;
+    }
+    else
+    {
+        calLast = s;
+        calIdle = 0;
+        calSum += t;
+        if (t < calMin) {calMin = t;}
+        if (t > calMax) {calMax = t;}
+        if (++calN < OSC_CAL_N) {return;}
+
+        //-----------------------------------------------------------
+        // Average within 1/32 (3.1%) of the nominal period, spread 
+        // max - min within 1/128 (0.78%) of the average
+        //-----------------------------------------------------------
+        uint32_t e = RECIP_TICK_HZ / calHz;
+        uint32_t a = calSum / OSC_CAL_N;
+        if ((a > e + (e >> 5)) || (a < e - (e >> 5)))
+        {
+            printc("Reference out of range\r\n\0");
+        }
+        else if ((calMax - calMin) > (a >> 7))
+        {
+            printc("Reference unstable\r\n\0");
+        }
+        else
+        {
+            int32_t h = (int32_t)(OSC_CAL_PPM / 2);
+            int32_t d = (int32_t)(calSum * calHz - OSC_CAL_TOTAL);
+            d = (d + ((d < 0) ? -h : h)) / (int32_t)OSC_CAL_PPM;
+            if ((d > OSC_PPM_MAX) || (d < -OSC_PPM_MAX))
+            {
+                printc("Reference out of range\r\n\0");
+            }
+            else
+            {
+                oscSet((int16_t)d);
+                eeRingSave(&oscRing, &oscPpm);
+                printc("Oscillator \0");
+                printPpm(oscPpm);
+            }
+        }
+        calHz = 0;
+    }
+    printc("\r\n\0");
+    printc(promptText);
+    return;
+}
+
+#undef OSC_CAL_PPM
+#undef OSC_CAL_TOTAL
+
+//----------------------------------------------------------------- end of file
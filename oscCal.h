@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------
+// File:   oscCal.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Oscillator calibration. Pulse periods are counted in TMR1 ticks assumed to
+// be 16 per us (FOSC/4 at 64 MHz), the internal oscillator is off by up to a
+// few percent. oscPpm is the measured error, > 0 when the oscillator runs
+// fast (more ticks per true second). Captures stay raw ticks; it is applied
+// where ticks are converted to time or frequency:
+//     analogOut.c   folded into K by aoutSetScale(), ISRs unchanged
+//     oscNominal()  ticks to nominal 16 MHz ticks for recipPeriodUs100() /
+//                   recipPeriodHz100(), multiply and shifts
+//     rtc.c         rtcSetTrim()
+// Alarm levels are ticks of this board, captured or set by value, and are
+// compared raw.
+//-----------------------------------------------------------------------------
+// Commissioning: feed a reference square wave of known frequency to the
+// sensor input and run "oscal <Hz>". The next OSC_CAL_N captured periods are
+// averaged, checked for spread and the result saved to EEPROM. 10..100 Hz 
+// gives the best resolution (one capture resolves 0.6 to 6 ppm), up to 
+// OSC_CAL_HZ_MAX is accepted. "oscal 0" clears the calibration. 
+// oscCalService() is run every tick by textTerminal_task() while a 
+// measurement is active, the console prompt follows its result. 
+//-----------------------------------------------------------------------------
+
+#ifndef OSCCAL_H
+#define	OSCCAL_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define OSC_PPM_MAX    (30000)  // +/- 3%
+#define OSC_CAL_N      (64)     // periods averaged, power of 2
+#define OSC_CAL_IDLE   (1000)   // ms without a capture to give up
+#define OSC_CAL_HZ_MIN (10)
+#define OSC_CAL_HZ_MAX (1000)
+
+extern int16_t oscPpm;
+
+void oscLoadFromEE(void);
+uint32_t oscNominal(uint32_t t);
+void oscCalStart(uint16_t hz);
+bool oscCalActive(void);
+void oscCalService(void);
+
+#endif	/* OSCCAL_H */
+
+//----------------------------------------------------------------- end of file
@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+// File:   recip.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Division by pulse period without the XC8 library divide, see recip.h. 
+//-----------------------------------------------------------------------------
+
+#include "recip.h"
+#include "uintegers2.h"
+
+//-----------------------------------------------------------------------------
+// recipSeed[i] = 2^23 / (128 + i + 0.5), rounded
+//-----------------------------------------------------------------------------
+const uint16_t __section("recip") recipSeed[128] = \
+{
+    65281, 64777, 64281, 63792, 63310, 62836, 62369, 61909,
+    61455, 61008, 60568, 60133, 59705, 59283, 58867, 58457,
+    58053, 57654, 57260, 56872, 56489, 56111, 55738, 55370,
+    55007, 54649, 54295, 53946, 53601, 53261, 52925, 52593,
+    52265, 51942, 51622, 51306, 50995, 50686, 50382, 50081,
+    49784, 49490, 49200, 48913, 48630, 48349, 48072, 47798,
+    47528, 47260, 46995, 46733, 46474, 46218, 45965, 45714,
+    45467, 45222, 44979, 44739, 44502, 44267, 44035, 43805,
+    43577, 43352, 43129, 42908, 42690, 42474, 42260, 42048,
+    41838, 41631, 41425, 41222, 41020, 40820, 40623, 40427,
+    40233, 40041, 39851, 39662, 39476, 39291, 39108, 38926,
+    38746, 38568, 38392, 38217, 38044, 37872, 37702, 37533,
+    37366, 37200, 37036, 36873, 36712, 36552, 36393, 36236,
+    36080, 35926, 35772, 35620, 35470, 35320, 35172, 35026,
+    34880, 34735, 34592, 34450, 34309, 34169, 34031, 33893,
+    33757, 33622, 33487, 33354, 33222, 33091, 32961, 32832
+};
+
+//-----------------------------------------------------------------------------
+// t is normalized to a 16-bit mantissa m (0x8000..0xFFFF), t ~ m x 2^e, 
+// and r ~ 2^31 / m (0x8000..0xFFFF) is kept with e for recipEst(). 
+//-----------------------------------------------------------------------------
+static uint16_t r;
+static int8_t e;
+
+//-----------------------------------------------------------------------------
+// recipEst() : x / t from r and e. x is split in 16-bit halves so that both 
+// products fit 32 bits, x r / 2^(31 + e) = (xH r + xL r / 2^16) / 2^(15 + e).
+// 15 + e is 0..23 for t < 2^24. Truncated, i.e. within 1 of x r / 2^(31+e). 
+//-----------------------------------------------------------------------------
+static uint32_t __section("recip") recipEst(uint32_t x)
+{
+    uinteger32_t a, b;
+    a.value = x;
+    b.value = (uint32_t)a.words.W0 * r;
+    a.value = (uint32_t)a.words.W1 * r + b.words.W1;
+    return a.value >> (15 + e);
+}
+
+uint32_t __section("recip") recipDiv(uint32_t n, uint32_t t)
+{
+    uinteger32_t m;
+    uint32_t q;
+    int32_t d;
+    
+    if (!t) {return UINT32_MAX;}
+    
+    //---------------------------------------------------------------
+    // Normalize: byte steps first, then bit steps, to 1xxxxxxx_xxxxxxxxb
+    //---------------------------------------------------------------
+    m.value = t;
+    e = 0;
+    if (!m.bytes.C2 && !m.bytes.C1) {m.value <<= 8; e -= 8;}
+    while (m.bytes.C2) {m.value >>= 1; ++e;}
+    while (!(m.bytes.C1 & 0x80)) {m.value <<= 1; --e;}
+    
+    //---------------------------------------------------------------
+    // Newton-Raphson: r = r0 + r0 (2^31 - m r0) / 2^31. The error term 
+    // is below 2^24 for the +/-0.4% seed, pre-shifted by 9 bits so that
+    // the product fits 31 bits. Clamp to 16 bits (m == 0x8000 wants
+    // 2^16, 1.5e-5 off). 
+    //---------------------------------------------------------------
+    r = recipSeed[m.bytes.C1 - 128];
+    d = (int32_t)(0x80000000UL - (uint32_t)m.words.W0 * r) >> 9;
+    d = (int32_t)r + (((int32_t)r * d) >> 22);
+    r = (d > UINT16_MAX) ? UINT16_MAX : (uint16_t)d;
+    
+    //---------------------------------------------------------------
+    // q is within 5e-5 x q + 2, the remainder d within 5e-5 x n + 3t,
+    // |d| < 2^31 as n < 2^31. One more estimate on the remainder, then
+    // a single step at most. 
+    //---------------------------------------------------------------
+    q = recipEst(n);
+    d = (int32_t)(n - q * t);
+    if (d < 0) {q -= recipEst((uint32_t)-d);} 
+    else {q += recipEst((uint32_t)d);}
+    d = (int32_t)(n - q * t);
+    while (d < 0) {--q; d += (int32_t)t;}
+    while (d >= (int32_t)t) {++q; d -= (int32_t)t;}
+    return q;
+}
+
+//----------------------------------------------------------------- end of file
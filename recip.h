@@ -0,0 +1,48 @@
+//-----------------------------------------------------------------------------
+// File:   recip.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Fixed-point reciprocal arithmetic for pulse periods. The PIC18 has an 8 x 8
+// hardware multiply but no divide, XC8 does a 32-bit division bit by bit in 
+// software. Here a division by a 24-bit period is done by multiplies: a table
+// seed for 1/t, one Newton-Raphson step, and a remainder correction that 
+// makes the result exact. 
+//-----------------------------------------------------------------------------
+// recipDiv(n, t) = floor(n / t), exact, for n < 2^31 and 0 < t < 2^24. 
+//     1/t seed   recipSeed[] by the top 8 bits of t, within +/-0.4% 
+//     Newton     r = r0 (2 - m r0), within 5e-5 (quadratic error plus 
+//                rounding of the 16-bit result)
+//     quotient   q = n r, within 5e-5 x q + 2
+//     correction a second q += rem r on the remainder, then at most one
+//                +/-1 step to the exact floor
+// tools/recipcheck.c checks this on the host for every t < 2^24, with 
+// n = 2^31-1, 1.6e9 (recipPeriodHz100()), 1e9 and random n.
+// t = 0 returns UINT32_MAX. 
+//-----------------------------------------------------------------------------
+
+#ifndef RECIP_H
+#define	RECIP_H
+
+#include "stdint.h"
+
+//-----------------------------------------------------------------------------
+// recipSeed[i] = 2^23 / (128 + i + 0.5), rounded. Reciprocal of an 8-bit 
+// mantissa 1xxxxxxxb, also used by analogOut.c in the capture ISRs. 
+//-----------------------------------------------------------------------------
+extern const uint16_t recipSeed[128];
+
+uint32_t recipDiv(uint32_t n, uint32_t t);
+
+//-----------------------------------------------------------------------------
+// TMR1 runs at 16 ticks per us. t in ticks to hundredths of a us or Hz, i.e.
+// values to be printed with 2 decimal places. Both exact (truncated). 
+//-----------------------------------------------------------------------------
+#define RECIP_TICK_HZ   (16000000UL)
+#define recipPeriodUs100(t) (((uint32_t)(t) * 25) >> 2)
+#define recipPeriodHz100(t) recipDiv(100 * RECIP_TICK_HZ, (t))
+
+#endif	/* RECIP_H */
+
+//----------------------------------------------------------------- end of file
@@ -4,50 +4,114 @@
 //
 // Created on March 3, 2020, 9:21 AM
 //-----------------------------------------------------------------------------
-// Real-time clock time-date sub-system, using XC8 library. Note that RTC 
+// Real-time clock time-date sub-system, using XC8 library. Note that RTC
 // should ideally be hardware for best performance in terms of both accuracy
-// and low power consumption.
+// and low power consumption. Driven by TMR5, see rtc.h.
 //-----------------------------------------------------------------------------
 
+#include "xc.h"
 #include "rtc.h"
 #include "stdint.h"
+#include "cocoos.h"
 
-#define COUNTER_RELOAD_VALUE (100)
+volatile uint16_t rtcStampHi;
 static time_t datetime;
-static uint8_t i = COUNTER_RELOAD_VALUE;
+static uint32_t secAcc;                         // stamp ticks into the second
+static uint32_t secTicks = RTC_STAMP_HZ;        // stamp ticks per second
 
 //-----------------------------------------------------------------------------
-// rtcTick() should be called at precise 1 second intervals typically from a 
-//           timer ISR. Alternatively, use rtcTick1() instead.
+// TMR5 free-running FOSC/4 1:8 (0.5 us), 16-bit read/write, gate off. The
+// overflow interrupt is high priority (interrupt_manager.c) so that 
+// RTC_STAMP() in the other high priority ISRs sees it either done or 
+// pending, never half way.
 //-----------------------------------------------------------------------------
-void __section("rtc") rtcTick(void) {++datetime; return;}
+void rtcInitialize(void)
+{
+    T5GCON = 0x00;
+    TMR5H = 0;
+    TMR5L = 0;
+    T5CON = 0x33;
+    PIR5bits.TMR5IF = 0;
+    PIE5bits.TMR5IE = 1;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// TMR5 overflow, every 65536 stamp ticks (32.768 ms), well below a second.
+//-----------------------------------------------------------------------------
+void __section("rtc") rtcTmr5_ISR(void)
+{
+    PIR5bits.TMR5IF = 0;
+    ++rtcStampHi;
+    secAcc += 0x10000;
+    if (secAcc >= secTicks) {secAcc -= secTicks; ++datetime;}
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// rtcStamp() : RTC_STAMP() for task code and low priority ISRs, with the
+// TMR5 interrupt held off.
+//-----------------------------------------------------------------------------
+uint32_t __section("rtc") rtcStamp(void)
+{
+    uinteger32_t x;
+    PIE5bits.TMR5IE = 0;
+    RTC_STAMP(x);
+    PIE5bits.TMR5IE = 1;
+    return x.value;
+}
+
+//-----------------------------------------------------------------------------
+// rtcSet() : set the clock, seconds since 00:00:00 on Jan 1, 1970 (UTC).
+// The second starts now.
+//-----------------------------------------------------------------------------
+void __section("rtc") rtcSet(time_t t)
+{
+    PIE5bits.TMR5IE = 0;
+    datetime = t;
+    secAcc = 0;
+    PIE5bits.TMR5IE = 1;
+    return;
+}
 
 //-----------------------------------------------------------------------------
-// rtcTick1() should be called at precise fraction of seconds intervals  
-//           typically from a timer ISR. EITHER use rtcTick1() OR rtcTick()
-//           to drive the clock. The rate is COUNTER_RELOAD_VALUE ticks per
-//           second. Adjust COUNTER_RELOAD_VALUE to suit exactly what the 
-//           "fraction" is. 
+// rtcSetTrim() : ppm > 0 when the oscillator runs fast, i.e. a second takes
+// RTC_STAMP_HZ x (1 + ppm/1e6) stamp ticks. Clamped to +/- RTC_TRIM_MAX.
 //-----------------------------------------------------------------------------
-void __section("rtc") rtcTick1(void) 
+void __section("rtc") rtcSetTrim(int16_t ppm)
 {
-    if(i) {--i;} else {i=COUNTER_RELOAD_VALUE; ++datetime;}
+    if (ppm > RTC_TRIM_MAX) {ppm = RTC_TRIM_MAX;}
+    else if (ppm < -RTC_TRIM_MAX) {ppm = -RTC_TRIM_MAX;}
+    PIE5bits.TMR5IE = 0;
+    secTicks = RTC_STAMP_HZ + (int32_t)ppm * (RTC_STAMP_HZ / 1000000UL);
+    PIE5bits.TMR5IE = 1;
     return;
 }
 
+//-----------------------------------------------------------------------------
+// rtcMillis() returns the milliseconds since power up, wrapping after 49
+// days. The OS tick is 1 ms (TMR0), so it is the OS tick count.
+//-----------------------------------------------------------------------------
+uint32_t __section("rtc") rtcMillis(void)
+{
+    return os_tick_get();
+}
+
 //-----------------------------------------------------------------------------
 // time() is prototyped in Microchip XC8 compiler. It is implemented here
 //           in accordance with XC8 User Guide specifications:
-// Return the current time in seconds which will be interpreted as the number 
-// of seconds since 00:00:00 on Jan 1, 1970. If the argument t is not equal to 
-// NULL, the same value will also be stored into the object pointed to by t. 
+// Return the current time in seconds which will be interpreted as the number
+// of seconds since 00:00:00 on Jan 1, 1970. If the argument t is not equal to
+// NULL, the same value will also be stored into the object pointed to by t.
 //-----------------------------------------------------------------------------
 time_t __section("rtc") time(time_t *t)
 {
-    if (t != NULL) {*t = datetime;}
-    return datetime;
+    time_t d;
+    PIE5bits.TMR5IE = 0;
+    d = datetime;
+    PIE5bits.TMR5IE = 1;
+    if (t != NULL) {*t = d;}
+    return d;
 }
 
-#undef COUNTER_RELOAD_VALUE
-
 //----------------------------------------------------------------- end of file
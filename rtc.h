@@ -4,17 +4,55 @@
 //
 // Created on March 3, 2020, 9:20 AM
 //-----------------------------------------------------------------------------
-// Real-time clock time-date sub-system, using XC8 library. 
+// Real-time clock time-date sub-system, using XC8 library.
+//-----------------------------------------------------------------------------
+// Time base is TMR5, free-running FOSC/4 1:8 (0.5 us) and never written, so
+// unlike the TMR0 tick (reloaded in its ISR) it does not lose counts. The
+// board has no 32.768 kHz crystal on SOSC (RC0/RC1 are outputs).
+//   (1) Stamp: TMR5 extended to 32 bits by rtcStampHi, counted up by the
+//       TMR5 overflow interrupt. Monotonic, RTC_STAMP_HZ, wraps after 35.8
+//       minutes; unsigned differences of stamps are correct below that.
+//   (2) Seconds: the overflow interrupt also counts time() up once per
+//       secTicks stamp ticks. rtcSetTrim() corrects for the oscillator
+//       (ppm, set from oscCal.c), the stamp itself is not trimmed.
+// TMR5 is otherwise only used by the ADC pulse sensing build (main0.c).
 //-----------------------------------------------------------------------------
 
 #ifndef RTC_H
 #define	RTC_H
 
+#include "xc.h"
 #include "time.h"
+#include "stdint.h"
+#include "uintegers2.h"
+
+#define RTC_STAMP_HZ    (2000000UL)     // stamp ticks per second
+#define RTC_STAMP_US(d) ((d) >> 1)      // stamp ticks to microseconds
+#define RTC_TRIM_MAX    (30000)         // +/- ppm, as OSC_PPM_MAX
 
-void rtcTick(void);
-void rtcTick1(void);
+extern volatile uint16_t rtcStampHi;
+
+//-----------------------------------------------------------------------------
+// RTC_STAMP(x) : x (uinteger32_t) = stamp now. For high priority ISRs only,
+// where the TMR5 overflow interrupt cannot run in between. An overflow that
+// is pending, and has already happened when TMR5 was read (high byte then
+// wrapped to low values), is added in. Task code and low priority ISRs use
+// rtcStamp() instead.
+//-----------------------------------------------------------------------------
+#define RTC_STAMP(x) \
+{ \
+    (x).bytes.C0 = TMR5L; \
+    (x).bytes.C1 = TMR5H; \
+    (x).words.W1 = rtcStampHi; \
+    if (PIR5bits.TMR5IF && !((x).bytes.C1 & 0x80)) {++(x).words.W1;} \
+}
+
+void rtcInitialize(void);
+void rtcTmr5_ISR(void);
+uint32_t rtcStamp(void);
+void rtcSet(time_t t);
+void rtcSetTrim(int16_t ppm);
+uint32_t rtcMillis(void);
 
 #endif	/* RTC_H */
 //----------------------------------------------------------------- end of file
-
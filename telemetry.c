@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+// File:   telemetry.c
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Record FIFO: written by the high priority capture ISRs (head), read by 
+// telemetry_task() (tail). Free-running uint8_t indices masked on access, 
+// each side writes only its own index. 
+//-----------------------------------------------------------------------------
+
+#include "telemetry.h"
+#include "cocoos.h"
+#include "textTerm.h"
+#include "crc16.h"
+#include "cobs.h"
+#include "uintegers2.h"
+
+#define TLM_FIFO_SIZE (8)       // power of 2
+#define TLM_PAYLOAD   (7)
+#define TLM_FRAME     (TLM_PAYLOAD+2)
+
+typedef struct
+{
+    uint8_t seq;
+    uint8_t flags;
+    uinteger24_t period;
+}
+tlmRecord_t;
+
+volatile bool tlmOn = false;
+static tlmRecord_t tlmFifo[TLM_FIFO_SIZE];
+static volatile uint8_t tlmHead, tlmTail;
+static uint8_t tlmSeq;                  // ISR only
+static bool tlmLost;                    // ISR only
+
+//-----------------------------------------------------------------------------
+// Start streaming from the next capture. Records queued before are dropped.
+//-----------------------------------------------------------------------------
+void __section("telemetry") tlmStart(void)
+{
+    tlmTail = tlmHead;
+    tlmOn = true;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Called by TMR1_GATE_ISR() and CMP1_ISR() while tlmOn. When the FIFO is 
+// full the record is dropped, seq still advances and TLM_F_LOST is set on 
+// the next record that makes it. 
+//-----------------------------------------------------------------------------
+void __section("telemetry") tlmCapture(uint8_t flags, uint32_t period)
+{
+    uinteger32_t x;
+    uint8_t h = tlmHead;
+    uint8_t seq = tlmSeq++;
+    if ((uint8_t)(h - tlmTail) >= TLM_FIFO_SIZE) {tlmLost = true; return;}
+    if (tlmLost) {flags |= TLM_F_LOST; tlmLost = false;}
+    tlmRecord_t *r = &tlmFifo[h & (TLM_FIFO_SIZE-1)];
+    x.value = period;
+    r->seq = seq;
+    r->flags = flags;
+    r->period.bytes.C0 = x.bytes.C0;
+    r->period.bytes.C1 = x.bytes.C1;
+    r->period.bytes.C2 = x.bytes.C2;
+    tlmHead = h + 1;
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Frames are only queued whole (printn() is all-or-nothing). When the TX ring
+// is full the record stays in the FIFO and is tried again. 
+//-----------------------------------------------------------------------------
+void __section("telemetry") telemetry_task(void)
+{
+    static uint8_t p[TLM_PAYLOAD], f[TLM_FRAME], n;
+    task_open();
+    for(;;)
+    {
+        task_wait(5);
+        while (tlmOn && (tlmTail != tlmHead))
+        {
+            tlmRecord_t *r = &tlmFifo[tlmTail & (TLM_FIFO_SIZE-1)];
+            uint16_t crc;
+            p[0] = r->seq;
+            p[1] = r->flags;
+            p[2] = r->period.bytes.C0;
+            p[3] = r->period.bytes.C1;
+            p[4] = r->period.bytes.C2;
+            crc = crc16Block(p, 5);
+            p[5] = (uint8_t)(crc & 0xFF);
+            p[6] = (uint8_t)(crc >> 8);
+            n = cobsEncode(p, TLM_PAYLOAD, f);
+            if (!printn(f, n)) {break;}
+            ++tlmTail;
+        }
+    }
+    task_close(); //--------- control will never fall onto this point
+}
+
+#undef TLM_FRAME
+#undef TLM_PAYLOAD
+#undef TLM_FIFO_SIZE
+
+//----------------------------------------------------------------- end of file
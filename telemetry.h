@@ -0,0 +1,43 @@
+//-----------------------------------------------------------------------------
+// File:   telemetry.h
+// Author: chi
+//
+// Created on October 19, 2026
+//-----------------------------------------------------------------------------
+// Binary capture telemetry on EUSART1 ("pod3"). Every pulse capture is put in
+// a record by the capture ISRs and streamed by telemetry_task() as a COBS 
+// frame with CRC-16. Decode on the host with tools/tlmdecode.py. 
+//-----------------------------------------------------------------------------
+// Frame on the wire: COBS(payload) followed by a 0x00 delimiter, 9 bytes. 
+// Payload, 7 bytes, multi-byte fields least significant byte first: 
+//     [0]    seq     capture sequence number, counts dropped records too
+//     [1]    flags   TLM_F_xxx below
+//     [2..4] period  24-bit. Gear continuous/single: TMR1 ticks (1/16 us)
+//                    Gear sparse: t0 + t1 in 25 ms steps
+//     [5..6] crc     crc16Block() of payload bytes [0..4]
+// At 38400 baud (3840 bytes/s) this is up to 426 records per second. 
+//-----------------------------------------------------------------------------
+
+#ifndef TELEMETRY_H
+#define	TELEMETRY_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define TLM_GEAR_SPARSE (0x00)
+#define TLM_GEAR_CONT   (0x01)
+#define TLM_GEAR_SINGLE (0x02)
+#define TLM_F_GEAR      (0x03) // mask, TLM_GEAR_xxx
+#define TLM_F_LOST      (0x04) // record(s) dropped before this one
+#define TLM_F_FIRST     (0x08) // first capture after a gear change
+#define TLM_F_TRIP      (0x10) // main alarm ISR fast path has tripped
+
+extern volatile bool tlmOn;
+
+void tlmStart(void);
+void tlmCapture(uint8_t flags, uint32_t period);
+void telemetry_task(void);
+
+#endif	/* TELEMETRY_H */
+
+//----------------------------------------------------------------- end of file
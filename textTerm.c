@@ -18,7 +18,7 @@
 //            the re-typed characters as part of the string.          17Feb2020
 //-----------------------------------------------------------------------------
 // MCC generated EUSART1 code usage
-//     EUSART1_Write() must check EUSART1_is_tx_ready() == true beforehand
+//     EUSART1_Write() is not used, transmit goes through textTermTx_ISR()
 //     EUSART1_Read()  must check EUSART1_is_rx_ready() == true beforehand
 //-----------------------------------------------------------------------------
 
@@ -33,15 +33,50 @@
 #include "opParam.h"
 #include "alarm.h"
 #include "i2a.h"
+#include "analogOut.h"
+#include "telemetry.h"
+#include "link.h"
+#include "csvLog.h"
+#include "eeQueue.h"
+#include "rtc.h"
+#include "oscCal.h"
 
 //-----------------------------------------------------------------------------
-// printa() implementation to queue const strings by their starting address
+// EUSART1 transmit path. Two queues feed the TX ISR textTermTx_ISR() which 
+// writes TXREG1 directly: 
+//   (1) txRing[], a byte ring. printa() and printb() copy into it, so RAM 
+//       buffers may be re-used as soon as the call returns. printu() 
+//       formats a value directly into it. 
+//   (2) txFlash[], a FIFO of flash string pointers queued by printc(). The 
+//       text is streamed out by the ISR without copying. Each entry records 
+//       the ring position at the time it was queued, which keeps the output
+//       order of the two queues. No in-band marker is used, hence the ring is
+//       binary-safe. 
+// Indices are free-running uint8_t, masked on access. Heads are written by
+// task code only, tails by the ISR only, so no interrupt masking is needed.
+// In link mode (link.c) the ISR is swapped out and the tails are advanced by
+// textTermTxPull() instead. 
 //-----------------------------------------------------------------------------
-#define PRINTA_BUFFER_SIZE (32)
-static uint8_t printaHead;
-static uint8_t printaTail;
-static uint8_t printaBufferRemaining;
-static char* printaBuf[PRINTA_BUFFER_SIZE];
+// txFlash[] holds the longest command reply, sysi with its prompt 
+// (CMD_PRINTC_MAX), plus one real-time report (8) queued meanwhile. Reports
+// check printcRoom() and printRoom() first, the terminal waits for 
+// CMD_PRINTC_MAX entries before running a typed line. 
+//-----------------------------------------------------------------------------
+#define TXRING_SIZE  (128)  // power of 2, <= 128
+#define TXFLASH_SIZE (32)   // power of 2, <= 128
+#define CMD_PRINTC_MAX (17) // printc() calls by sysi and textTermLine()
+static uint8_t txRing[TXRING_SIZE];
+static volatile uint8_t txHead, txTail;
+
+typedef struct
+{
+    const char *s;
+    uint8_t at;             // txHead when queued: stream before txRing[at]
+}
+txFlash_t;
+static txFlash_t txFlash[TXFLASH_SIZE];
+static volatile uint8_t txFlashHead, txFlashTail;
+static const char *txFlashCur = NULL; // tail side: flash string being sent
 
 //-----------------------------------------------------------------------------
 // parse input strings from EUSART1 as part of the text terminal service
@@ -50,72 +85,563 @@ static char* printaBuf[PRINTA_BUFFER_SIZE];
 static uint8_t charCont;
 static char parseBuf[PARSE_BUFFER_SIZE];
 
+//-----------------------------------------------------------------------------
+// textTermTx_ISR()
+// Installed as the EUSART1 TX interrupt handler in main(). Sends one byte per
+// interrupt: a due flash string first, then the ring. Disables itself when 
+// both are empty, the print functions re-enable it. 
+//-----------------------------------------------------------------------------
+void __section("textTerm") textTermTx_ISR(void)
+{
+    for(;;)
+    {
+        if (txFlashCur != NULL)
+        {
+            char c = *txFlashCur++;
+            if (c != '\0') {TXREG1 = c; return;}
+            txFlashCur = NULL;
+            ++txFlashTail; //------------ entry is released when sent
+        }
+        if ((txFlashTail != txFlashHead) 
+         && (txFlash[txFlashTail & (TXFLASH_SIZE-1)].at == txTail))
+        {
+            txFlashCur = txFlash[txFlashTail & (TXFLASH_SIZE-1)].s;
+            continue;
+        }
+        if (txTail != txHead)
+        {
+            TXREG1 = txRing[txTail & (TXRING_SIZE-1)];
+            ++txTail;
+            return;
+        }
+        PIE1bits.TX1IE = 0;
+        return;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// textTermTxPull()
+// Link mode counterpart of textTermTx_ISR(), called by linkService() while 
+// the ISR is not installed. Takes the queued output in the same order. 
+// Input:  b[] room for max bytes
+// Output: the number of bytes taken, 0 == nothing queued
+//-----------------------------------------------------------------------------
+uint8_t __section("textTerm") textTermTxPull(uint8_t* b, uint8_t max)
+{
+    uint8_t n = 0;
+    while (n < max)
+    {
+        if (txFlashCur != NULL)
+        {
+            char c = *txFlashCur;
+            if (c != '\0') {b[n++] = (uint8_t)c; ++txFlashCur; continue;}
+            txFlashCur = NULL;
+            ++txFlashTail;
+        }
+        if ((txFlashTail != txFlashHead) 
+         && (txFlash[txFlashTail & (TXFLASH_SIZE-1)].at == txTail))
+        {
+            txFlashCur = txFlash[txFlashTail & (TXFLASH_SIZE-1)].s;
+            continue;
+        }
+        if (txTail == txHead) {break;}
+        b[n++] = txRing[txTail & (TXRING_SIZE-1)];
+        ++txTail;
+    }
+    return n;
+}
+
+//-----------------------------------------------------------------------------
+// textTermTxIdle()
+// Output: true == both queues are empty and the last byte has left the UART
+//-----------------------------------------------------------------------------
+bool __section("textTerm") textTermTxIdle(void)
+{
+    return (txTail == txHead) && (txFlashTail == txFlashHead) 
+        && (TXSTA1bits.TRMT == 1);
+}
+
 //-----------------------------------------------------------------------------
 // printa()
-// Input:  the starting address of a string which is to be shifted out to the 
-//         EUSART1. The address is put on the local buffer. The string content
-//         should not be changed before it has a chance to get shifted out. 
-//         The implementation is particularly suited for ROM/FLASH strings. 
-//         *a is expected to be a valid non-NULL address. 
+// Input:  a RAM string, copied to the TX ring. The caller's buffer may be 
+//         modified as soon as this returns. *a is expected to be a valid 
+//         non-NULL address. 
 // Output: true  == success
-//         false == buffer is full, the address of the string is not cloned 
-//                  to the local string pointer buffer.
+//         false == not enough room, nothing is queued (all or nothing, a 
+//                  report is never cut in the middle of a value)
 //-----------------------------------------------------------------------------
 bool __section("textTerm") printa(char* a)
 {
-    if (!printaBufferRemaining) {return false;}
-    printaBuf[printaHead++] = a;
-    if(PRINTA_BUFFER_SIZE <= printaHead) {printaHead = 0;}
-    printaBufferRemaining--;
+    uint8_t n = (uint8_t)strlen(a);
+    uint8_t h = txHead;
+    if (n > (uint8_t)(TXRING_SIZE - (uint8_t)(h - txTail))) {return false;}
+    while (n--) {txRing[h++ & (TXRING_SIZE-1)] = (uint8_t)*a++;}
+    txHead = h;
+    PIE1bits.TX1IE = 1;
     return true;
 }
 
 //-----------------------------------------------------------------------------
-// print_task()
-// Shifted out strings (whose address in in the FIFO buffer) to EUSART1. The 
-// string contents should not be changed until after they have been shifted out
-// (but there is no facility to enquire this info). The implementation is 
-// particularly suited for ROM/FLASH strings. 
+// printb()
+// Input:  one byte (any value) to the TX ring. 
+// Output: true == success, false == ring is full
 //-----------------------------------------------------------------------------
-void __section("textTerm") print_task(void)
+bool __section("textTerm") printb(uint8_t b)
 {
-    static char* a;
-    task_open();
-    //---------------------------------------------------------------
-    // Initialization code after task_open() will only execute once. 
-    //---------------------------------------------------------------
-    printaHead = printaTail = 0;
-    printaBufferRemaining = PRINTA_BUFFER_SIZE;
-    //---------------------------------------------------------------
-    // Infinite task loop
-    //---------------------------------------------------------------
-    for(;;) {
-        if (PRINTA_BUFFER_SIZE > printaBufferRemaining)
+    uint8_t h = txHead;
+    if ((uint8_t)(h - txTail) >= TXRING_SIZE) {return false;}
+    txRing[h++ & (TXRING_SIZE-1)] = b;
+    txHead = h;
+    PIE1bits.TX1IE = 1;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// printn()
+// Input:  n bytes (any value) to the TX ring, for binary frames. 
+// Output: true  == success
+//         false == not enough room, nothing is queued
+//-----------------------------------------------------------------------------
+bool __section("textTerm") printn(const uint8_t* b, uint8_t n)
+{
+    uint8_t h = txHead;
+    if (n > (uint8_t)(TXRING_SIZE - (uint8_t)(h - txTail))) {return false;}
+    while (n--) {txRing[h++ & (TXRING_SIZE-1)] = *b++;}
+    txHead = h;
+    PIE1bits.TX1IE = 1;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// printu()
+// Input:  v formatted by u32Fmt() (i2a.c) with format f and width w, written
+//         straight into the TX ring without an intermediate string. 
+// Output: true  == success
+//         false == not enough room, nothing is queued
+//-----------------------------------------------------------------------------
+bool __section("textTerm") printu(uint32_t v, uint8_t f, uint8_t w)
+{
+    uint8_t n = u32FmtLen(v, f, w);
+    uint8_t h = txHead;
+    if (n > (uint8_t)(TXRING_SIZE - (uint8_t)(h - txTail))) {return false;}
+    u32Fmt(v, f, w, (char*)txRing, h, TXRING_SIZE-1);
+    txHead = h + n;
+    PIE1bits.TX1IE = 1;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// printRoom()
+// Output: free bytes in the TX ring. Task code queuing several items that
+//         must not be cut apart checks this first. 
+//-----------------------------------------------------------------------------
+uint8_t __section("textTerm") printRoom(void)
+{
+    return (uint8_t)(TXRING_SIZE - (uint8_t)(txHead - txTail));
+}
+
+//-----------------------------------------------------------------------------
+// printcRoom()
+// Output: free entries in the flash pointer FIFO, the printc() counterpart 
+//         of printRoom(). 
+//-----------------------------------------------------------------------------
+uint8_t __section("textTerm") printcRoom(void)
+{
+    return (uint8_t)(TXFLASH_SIZE - (uint8_t)(txFlashHead - txFlashTail));
+}
+
+//-----------------------------------------------------------------------------
+// printc()
+// Input:  the starting address of a constant (flash) string. Only the address
+//         is queued, the string must stay unchanged until it has been sent, 
+//         which is always the case for flash. 
+// Output: true  == success
+//         false == flash pointer FIFO is full, the string is not queued
+//-----------------------------------------------------------------------------
+bool __section("textTerm") printc(const char* a)
+{
+    uint8_t h = txFlashHead;
+    if ((uint8_t)(h - txFlashTail) >= TXFLASH_SIZE) {return false;}
+    txFlash[h & (TXFLASH_SIZE-1)].s = a;
+    txFlash[h & (TXFLASH_SIZE-1)].at = txHead;
+    txFlashHead = h + 1;
+    PIE1bits.TX1IE = 1;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Console command handlers. Those without a value receive the table entry's
+// param (e.g. the digit of pod0/pod1/pod3), the others the parsed value which
+// is already range-checked against the entry's argMax. 
+//-----------------------------------------------------------------------------
+static void __section("textTerm") cmdHelp(uint32_t v)
+{
+    printc(helpText);
+    return;
+}
+
+static void __section("textTerm") cmdEula(uint32_t v)
+{
+    printc(eulaHeadText);
+    printc(cocoOSLicenseText);
+    return;
+}
+
+static void __section("textTerm") cmdCmps(uint32_t v)
+{
+    printc("\r\nTrigger at \0");
+    printu(cmpTrigMv(), FMT_FIX(3), 0);
+    printc(" volts\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdSysi(uint32_t v)
+{
+    printc(devConfigText0);
+    
+    printc("Pre- alarm \0");
+    printu(pAlarmLevel, FMT_HEX(3), 0);
+    printc("\r\n\0");
+    
+    printc("Main alarm \0");
+    printu(mAlarmLevel, FMT_HEX(3), 0);
+    printc("\r\n\0");
+    
+    printc("Sampling interval \0");
+    printu(sampleInterval, FMT_DEC, 0);
+    printc(" x10ms\r\n\0");
+    
+    printc("Hi-Lo threshold \0");
+    printu(cmpTrigMv(), FMT_FIX(3), 0);
+    printc(" volt(s)\r\n\0");
+    
+    printc("Analog output 0V \0");
+    printu(aoutZeroHz, FMT_DEC, 0);
+    printc(" Hz, 5V \0");
+    printu(aoutFullHz, FMT_DEC, 0);
+    printc(" Hz\r\nProfile \0");
+    printu(opGetProfile(), FMT_DEC, 0);
+    printc("\r\nAlarm state \0");
+    printu(alarmState, FMT_DEC, 0);
+    printc(" for \0");
+    printu(alarmAgeMs(), FMT_FIX(3), 0);
+    printc(" s\r\n\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdPod(uint32_t v)
+{
+    printRealTimeData = (v == 1);
+    tlmOn = false;
+    csvOn = false;
+    switch ((uint8_t)v)
+    {
+        case 0:  printc(rtDataOffText); break;
+        case 1:  printc(rtDataOnText);  break;
+        default: printc(tlmOnText); tlmStart(); break;
+    }
+    return;
+}
+
+static void __section("textTerm") cmdPod2(uint32_t v)
+{
+    if (v == 0) {printc("\r\nInvalid Value\r\n\0"); return;}
+    printRealTimeData = false;
+    tlmOn = false;
+    printc(csvOnText);
+    csvStart((uint8_t)v);
+    return;
+}
+
+static void __section("textTerm") cmdAlmset(uint32_t v)
+{
+    switch ((uint8_t)v)
+    {
+        case 0:
+            opZeroAllAlarmLevels();
+            printc("\r\nAlarm levels zero-ed\r\n\0");
+            break;
+        case 1:
+            printc("\r\nSet pre- alarm \0");
+            opSetPre_AlarmFromCapture();
+            printu(pAlarmLevel, FMT_HEX(3), 0);
+            printc("\r\n\0");
+            break;
+        default:
+            printc("\r\nSet main alarm \0");
+            opSetMainAlarmFromCapture();
+            printu(mAlarmLevel, FMT_HEX(3), 0);
+            printc("\r\n\0");
+            break;
+    }
+    return;
+}
+
+static void __section("textTerm") cmdAlevel1(uint32_t v)
+{
+    printc("\r\nSet pre- alarm \0");
+    opSetPre_AlarmByValue(v);
+    printu(pAlarmLevel, FMT_HEX(3), 0);
+    printc("\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdAlevel2(uint32_t v)
+{
+    printc("\r\nSet main alarm \0");
+    opSetMainAlarmByValue(v);
+    printu(mAlarmLevel, FMT_HEX(3), 0);
+    printc("\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdVolthre(uint32_t v)
+{
+    printc("\r\nHi-Lo threshold \0");
+    opSetCmpVoltThresholdByValue((uint8_t)v);
+    printu(cmpTrigMv(), FMT_FIX(3), 0);
+    printc(" volts\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdSamplei(uint32_t v)
+{
+    printc("\r\nSampling interval \0");
+    opSetAlarmSamplingInterval((uint8_t)v);
+    printu(sampleInterval, FMT_DEC, 0);
+    printc(" x10ms\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdAnazero(uint32_t v)
+{
+    printc("\r\nAnalog output 0V at \0");
+    opSetAnalogZeroByValue((uint16_t)v);
+    printu(aoutZeroHz, FMT_DEC, 0);
+    printc(" Hz\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdAnafull(uint32_t v)
+{
+    printc("\r\nAnalog output 5V at \0");
+    opSetAnalogFullByValue((uint16_t)v);
+    printu(aoutFullHz, FMT_DEC, 0);
+    printc(" Hz\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdProf(uint32_t v)
+{
+    printc("\r\nProfile \0");
+    opSelectProfile((uint8_t)v);
+    printu(opGetProfile(), FMT_DEC, 0);
+    printc(" in use\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdWear(uint32_t v)
+{
+    const eeRing_t *r = &opRing[opGetProfile()];
+    printc("\r\nProfile \0");
+    printu(opGetProfile(), FMT_DEC, 0);
+    printc(" saves \0");
+    printu(r->gen, FMT_DEC, 0);
+    printc(" over \0");
+    printu(r->slots, FMT_DEC, 0);
+    printc(" slots\r\nWrites per cell <= \0");
+    printu(eeRingWear(r), FMT_DEC, 0);
+    printc(" of \0");
+    printu(EE_ENDURANCE, FMT_DEC, 0);
+    printc("\r\nWrite errors \0");
+    printu(eeErrors, FMT_DEC, 0);
+    printc("\r\n\0");
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Date and time as YYYY-MM-DD hh:mm:ss UTC. print2() writes the two digit 
+// fields with a leading zero. 
+//-----------------------------------------------------------------------------
+static void __section("textTerm") print2(uint8_t x)
+{
+    printb((uint8_t)('0' + x / 10));
+    printb((uint8_t)('0' + x % 10));
+    return;
+}
+
+static void __section("textTerm") cmdTime(uint32_t v)
+{
+    time_t t = time(NULL);
+    struct tm *d = gmtime(&t);
+    printc("\r\n\0");
+    printu((uint32_t)d->tm_year + 1900, FMT_DEC, 0);
+    printb('-');
+    print2((uint8_t)(d->tm_mon + 1));
+    printb('-');
+    print2((uint8_t)d->tm_mday);
+    printb(' ');
+    print2((uint8_t)d->tm_hour);
+    printb(':');
+    print2((uint8_t)d->tm_min);
+    printb(':');
+    print2((uint8_t)d->tm_sec);
+    printc(" UTC (\0");
+    printu((uint32_t)t, FMT_DEC, 0);
+    printc(")\r\n\0");
+    return;
+}
+
+static void __section("textTerm") cmdSettime(uint32_t v)
+{
+    rtcSet((time_t)v);
+    cmdTime(v);
+    return;
+}
+
+static void __section("textTerm") cmdOscal(uint32_t v)
+{
+    if (v && (v < OSC_CAL_HZ_MIN)) {printc("\r\nInvalid Value\r\n\0"); return;}
+    oscCalStart((uint16_t)v);
+    return;
+}
+
+static void __section("textTerm") cmdLink(uint32_t v)
+{
+    printc(linkOnText);
+    linkStart();
+    return;
+}
+
+//-----------------------------------------------------------------------------
+// Command table in flash. An entry matches when the input line begins with 
+// its name. argMax == 0: no value, the line must be the name alone. Else the
+// rest of the line is the value, decimal or 0x hex, leading spaces allowed, 
+// in range 0..argMax. Names must not be a prefix of one another. 
+//-----------------------------------------------------------------------------
+#define CMD_NAME_SIZE (8)
+typedef struct
+{
+    char name[CMD_NAME_SIZE];
+    void (*handler)(uint32_t);
+    uint32_t argMax;
+    uint8_t param;
+}
+command_t;
+
+const command_t __section("textTerm") commandTable[] = \
+{
+    {"?",       cmdHelp,    0,          0},
+    {"help",    cmdHelp,    0,          0},
+    {"eula",    cmdEula,    0,          0},
+    {"cmps",    cmdCmps,    0,          0},
+    {"sysi",    cmdSysi,    0,          0},
+    {"pod0",    cmdPod,     0,          0},
+    {"pod1",    cmdPod,     0,          1},
+    {"pod2",    cmdPod2,    CSV_RATE_MAX, 0},
+    {"pod3",    cmdPod,     0,          3},
+    {"almset0", cmdAlmset,  0,          0},
+    {"almset1", cmdAlmset,  0,          1},
+    {"almset2", cmdAlmset,  0,          2},
+    {"alevel1", cmdAlevel1, 0x00FFFFFF, 0},
+    {"alevel2", cmdAlevel2, 0x00FFFFFF, 0},
+    {"volthre", cmdVolthre, UINT8_MAX,  0},
+    {"samplei", cmdSamplei, UINT8_MAX,  0},
+    {"anazero", cmdAnazero, UINT16_MAX, 0},
+    {"anafull", cmdAnafull, UINT16_MAX, 0},
+    {"prof",    cmdProf,    OP_PROFILES - 1, 0},
+    {"wear",    cmdWear,    0,          0},
+    {"time",    cmdTime,    0,          0},
+    {"settime", cmdSettime, INT32_MAX,  0},
+    {"oscal",   cmdOscal,   OSC_CAL_HZ_MAX, 0},
+    {"link",    cmdLink,    0,          0},
+};
+#define N_COMMANDS (sizeof(commandTable)/sizeof(commandTable[0]))
+
+//-----------------------------------------------------------------------------
+// commandDispatch()
+// Input:  a == first non-space character of the line, n == length without 
+//         trailing spaces (n > 0). 
+// Output: true  == command found and handled, including "Invalid Value"
+//         false == no such command
+// The first character is compared before anything else, which rejects all 
+// but one or a few entries in a single compare each. Numeric values for every
+// command are parsed here and only here. 
+//-----------------------------------------------------------------------------
+static bool __section("textTerm") commandDispatch(char *a, uint8_t n)
+{
+    const command_t *c = commandTable;
+    for (uint8_t k = 0; k < N_COMMANDS; ++k, ++c)
+    {
+        if (c->name[0] != a[0]) {continue;}
+        uint8_t l = (uint8_t)strlen(c->name);
+        if ((l > n) || (memcmp(a, c->name, l) != 0)) {continue;}
+        if (!c->argMax)
+        {
+            if (l != n) {continue;}
+            c->handler(c->param);
+            return true;
+        }
+        
+        uint32_t v;
+        bool isValid = false;
+        if (n > l) 
         {
-            //---------------------------------
-            // Obtain the pointer to the string
-            //---------------------------------
-            a = printaBuf[printaTail++];
-            //---------------------------------
-            // Update FIFO buffer state
-            //---------------------------------
-            if(PRINTA_BUFFER_SIZE <= printaTail) {printaTail = 0;}
-            printaBufferRemaining++;
-            //---------------------------------
-            // Stream the string to EUSART
-            //---------------------------------
-            if (a != NULL)
-            {
-                while (*a != '\0')
-                {
-                    while (!EUSART1_is_tx_ready()) {task_wait(5);}
-                    EUSART1_Write(*a++);
-                }
-            }
+            isValid = hexStringtoi32(&a[l], n-l, &v);
+            if (!isValid) {isValid = decStringtoi32(&a[l], n-l, &v);}
         }
-        task_wait(10);
+        if (!isValid || v > c->argMax) {printc("\r\nInvalid Value\r\n\0");}
+        else {c->handler(v);}
+        return true;
     }
-    task_close(); //--------- control will never fall onto this point
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// textTermLine()
+// Runs one input line as a command and prompts for the next. Used for lines
+// typed in text mode and for command frames in link mode. 
+// Input:  a[n] the line without CR / LF, n may be 0
+//-----------------------------------------------------------------------------
+void __section("textTerm") textTermLine(char* a, uint8_t n)
+{
+    if (n > 0) 
+    {
+        //----------------------------------------------------------------
+        // trim leading spaces. i => index of first non-space char
+        //----------------------------------------------------------------
+        uint8_t i = 0;
+        while ((i < n) && (a[i] == ' ')) {++i;}
+        
+        //----------------------------------------------------------------
+        // trim trailing spaces. j => index first space after string body
+        //----------------------------------------------------------------
+        uint8_t j = n;
+        while ((j > i) && (a[j-1] == ' ')) {--j;}
+        
+        //----------------------------------------------------------------
+        // Look the command up in commandTable[] and run it
+        //----------------------------------------------------------------
+        bool isCommandValid = (j == i) ? true //------- empty is pardoned
+                            : commandDispatch(&a[i], j-i);
+        
+        //----------------------------------------------------------------
+        // Prompt user with help suggestions
+        //----------------------------------------------------------------
+        if (isCommandValid == false)
+        {
+            printc(parseErrText);
+        }
+    }
+    //--------------------------------------------------------------------
+    // Display / output a fresh prompt to the user. Link mode clients take
+    // it as the end of the reply. A command still measuring (oscal) 
+    // prompts when done. 
+    //--------------------------------------------------------------------
+    if (oscCalActive()) {return;}
+    printc("\r\n\0");
+    printc(promptText);
+    return;
 }
 
 //-----------------------------------------------------------------------------
@@ -138,280 +664,36 @@ void __section("textTerm") textTerminal_task(void)
     uint8_t a;
     task_open();
     charCont = 0;
-    printa((char*)welcomeText); 
-    printa((char*)promptText);
+    printc(welcomeText); 
+    printc(promptText);
     for(;;) {
+        //----------------------------------------------------------------
+        // Link mode: input and output are serviced by link.c every tick
+        //----------------------------------------------------------------
+        while (linkActive()) 
+        {
+            task_wait(1);
+            oscCalService();
+            linkService();
+            if (!linkActive()) {printc(promptText);}
+        }
+        while (oscCalActive()) {task_wait(1); oscCalService();}
         while (!EUSART1_is_rx_ready()) {task_wait(20);}
         a = EUSART1_Read();
-        while (!EUSART1_is_tx_ready()) {task_wait(5);}
-        EUSART1_Write(a);
+        printb(a); //----------------------------------------------- echo
         if (a == '\r' || a == '\n') 
         {
         //----------------------------------------------------------------
         // CR / LF : the input string collected from previous iterations 
-        //           will be parsed as a command. 
+        //           will be parsed as a command. Lines typed ahead wait 
+        //           until the reply to the longest command fits. 
         //----------------------------------------------------------------
-            if (charCont > 0) 
-            {
-                //--------------------------------------------------------
-                // trim leading spaces. i => index of first non-space char
-                //--------------------------------------------------------
-                uint8_t i = 0;
-                while ((i < charCont) && (parseBuf[i] == ' ')) {++i;}
-                
-                //--------------------------------------------------------
-                // trim trailing spaces. j => index first space after 
-                // string body
-                //--------------------------------------------------------
-                uint8_t j = charCont;
-                while ((j > i) && (parseBuf[j-1] == ' ')) {--j;}
-                
-                //--------------------------------------------------------
-                // Use string length as preliminary check if command is 
-                // valid. If so execute the identified command. 
-                //--------------------------------------------------------
-                bool isCommandValid = false;
-                switch (j-i)
-                {
-                    case 0:
-                        isCommandValid = true; // empty input is pardoned
-                        break;
-                    case 1:
-                        if (parseBuf[i] == '?') 
-                        {
-                            printa((char*)helpText);
-                            isCommandValid = true;
-                        }
-                        break;
-                    case 4:
-                        if (parseBuf[i+0] == 'h' && parseBuf[i+1] == 'e'
-                         && parseBuf[i+2] == 'l' && parseBuf[i+3] == 'p')
-                        {
-                            printa((char*)helpText);
-                            isCommandValid = true;
-                        }
-                        else if (parseBuf[i+0] == 'e' && parseBuf[i+1] == 'u'
-                              && parseBuf[i+2] == 'l' && parseBuf[i+3] == 'a')
-                        {
-                            printa((char*)eulaHeadText);
-                            printa((char*)cocoOSLicenseText);
-                            isCommandValid = true;
-                        }
-                        else if (parseBuf[i+0] == 'c' && parseBuf[i+1] == 'm'
-                              && parseBuf[i+2] == 'p' && parseBuf[i+3] == 's')
-                        {
-                            printa((char*)"\r\nTrigger at \0");
-                            printa(cmpTrigVoltage());
-                            printa((char*)" volts\r\n\0");
-                            isCommandValid = true;
-                        }
-                        else if (parseBuf[i+0] == 's' && parseBuf[i+1] == 'y'
-                              && parseBuf[i+2] == 's' && parseBuf[i+3] == 'i')
-                        {
-                            printa((char*)devConfigText0);
-                            
-                            printa((char*)"Pre- alarm \0");
-                            printa(pAlarmHexString());
-                            printa((char*)"\r\n\0");
-                            
-                            printa((char*)"Main alarm \0");
-                            printa(mAlarmHexString());
-                            printa((char*)"\r\n\0");
-                            
-                            printa((char*)"Sampling interval \0");
-                            printa(mIntervalDecString());
-                            printa((char*)" x10ms\r\n\0");
-                            
-                            printa((char*)"Hi-Lo threshold \0");
-                            printa(cmpTrigVoltage());
-                            printa((char*)" volt(s)\r\n\r\n\0");
-                            
-                            isCommandValid = true;    
-                        }
-                        else if (parseBuf[i+0] == 'p' && parseBuf[i+1] == 'o'
-                              && parseBuf[i+2] == 'd')
-                        {
-                            switch(parseBuf[i+3])
-                            {
-                                case '0':
-                                    printa((char*)rtDataOffText);
-                                    printRealTimeData = false;
-                                    isCommandValid = true;    
-                                    break;
-                                case '1':
-                                    printa((char*)rtDataOnText);
-                                    printRealTimeData = true;
-                                    isCommandValid = true;
-                                    break;
-                                default:
-                                    break;
-                            }
-                        }
-                        break;
-                    case 7:
-                        if (parseBuf[i+0] == 'a' && parseBuf[i+1] == 'l'
-                         && parseBuf[i+2] == 'm' && parseBuf[i+3] == 's'
-                         && parseBuf[i+4] == 'e' && parseBuf[i+5] == 't')
-                        {
-                            switch(parseBuf[i+6])
-                            {
-                                case '0':
-                                    opZeroAllAlarmLevels();
-                                    printa((char*)"\r\nAlarm levels zero-ed\r\n\0");
-                                    isCommandValid = true;    
-                                    break;    
-                                case '1':
-                                    printa((char*)"\r\nSet pre- alarm \0");
-                                    opSetPre_AlarmFromCapture();
-                                    printa(pAlarmHexString());
-                                    printa((char*)"\r\n\0");
-                                    isCommandValid = true;    
-                                    break;
-                                case '2':
-                                    printa((char*)"\r\nSet main alarm \0");
-                                    opSetMainAlarmFromCapture();
-                                    printa(mAlarmHexString());
-                                    printa((char*)"\r\n\0");
-                                    isCommandValid = true;    
-                                    break;
-                                default:
-                                    break;
-                            }
-                        }
-                    default:
-                        //------------------------------------------------
-                        //aleve1 alevel2
-                        //------------------------------------------------
-                        if (parseBuf[i+0] == 'a' && parseBuf[i+1] == 'l'
-                         && parseBuf[i+2] == 'e' && parseBuf[i+3] == 'v'
-                         && parseBuf[i+4] == 'e' && parseBuf[i+5] == 'l')
-                        {
-                            if((parseBuf[i+6]!='1') && (parseBuf[i+6]!='2'))
-                                { break; }
-                            
-                            uint32_t v;
-                            bool isValid = false;
-                            
-                            if ((j-i)>7) 
-                            {
-                                isValid = hexStringtoi32(&parseBuf[i+7], j-i-7, &v);
-                                if (!isValid) 
-                                    {isValid = decStringtoi32(&parseBuf[i+7], j-i-7, &v);}
-                            }
-                            
-                            if (!isValid || v > 0xFFFFFF) 
-                            {
-                                printa((char*)"\r\nInvalid Value\r\n\0"); 
-                                isCommandValid = true; 
-                                break;
-                            }
-
-                            switch (parseBuf[i+6])
-                            {
-                                case '1':
-                                    printa((char*)"\r\nSet pre- alarm \0");
-                                    opSetPre_AlarmByValue(v);
-                                    printa(pAlarmHexString());
-                                    printa((char*)"\r\n\0");
-                                    isCommandValid = true;    
-                                    break;
-                                case '2':
-                                    printa((char*)"\r\nSet main alarm \0");
-                                    opSetMainAlarmByValue(v);
-                                    printa(mAlarmHexString());
-                                    printa((char*)"\r\n\0");
-                                    isCommandValid = true;    
-                                    break;
-                                default:
-                                    break;
-                            }
-                            //--------------------------------------------
-                            // When program control flow after this block, 
-                            // if isCommandValid is 'false' a message 
-                            // corresponding to this issue will be emitted
-                            // to the ESUART to appropriately notify the
-                            // user. 
-                            //--------------------------------------------
-                        }
-                        //------------------------------------------------
-                        //volthre
-                        //------------------------------------------------
-                        else if (parseBuf[i+0] == 'v' && parseBuf[i+1] == 'o'
-                         && parseBuf[i+2] == 'l' && parseBuf[i+3] == 't'
-                         && parseBuf[i+4] == 'h' && parseBuf[i+5] == 'r'
-                         && parseBuf[i+6] == 'e')
-                        {
-                            uint32_t v;
-                            bool isValid = false;
-                            if ((j-i)>7) 
-                            {
-                                isValid = hexStringtoi32(&parseBuf[i+7], j-i-7, &v);
-                                if (!isValid) 
-                                    {isValid = decStringtoi32(&parseBuf[i+7], j-i-7, &v);}
-                            }
-                            
-                            if (!isValid || v > UINT8_MAX) 
-                                {printa((char*)"\r\nInvalid Value\r\n\0");}
-                            else   
-                            {
-                                static char s[11];
-                                printa((char*)"\r\nHi-Lo threshold \0");
-                                opSetCmpVoltThresholdByValue((uint8_t)(v & 0xFF));
-                                printa(cmpTrigVoltage());
-                                printa((char*)" volts\r\n\0");
-                            }
-                            
-                            isCommandValid = true;    
-                        }
-                        //------------------------------------------------
-                        //samplei
-                        //------------------------------------------------
-                        else if (parseBuf[i+0] == 's' && parseBuf[i+1] == 'a'
-                         && parseBuf[i+2] == 'm' && parseBuf[i+3] == 'p'
-                         && parseBuf[i+4] == 'l' && parseBuf[i+5] == 'e'
-                         && parseBuf[i+6] == 'i')
-                        {
-                            uint32_t v;
-                            bool isValid = false;
-                            if ((j-i)>7) 
-                            {
-                                isValid = hexStringtoi32(&parseBuf[i+7], j-i-7, &v);
-                                if (!isValid) 
-                                    {isValid = decStringtoi32(&parseBuf[i+7], j-i-7, &v);};
-                            }
-                            
-                            if (!isValid || v > UINT8_MAX) 
-                                {printa((char*)"\r\nInvalid Value\r\n\0");}
-                            else   
-                            {
-                                static char s[11];
-                                printa((char*)"\r\nSampling interval \0");
-                                opSetAlarmSamplingInterval((uint8_t)(v & 0xFF));
-                                printa(mIntervalDecString());
-                                printa((char*)" x10ms\r\n\0");
-                            }
-                            
-                            isCommandValid = true;    
-                        }
-                        break;
-                }
-                //--------------------------------------------------------
-                // Prompt user with help suggestions
-                //--------------------------------------------------------
-                if (isCommandValid == false)
-                {
-                    printa((char*)parseErrText);
-                }
-            }
-            printa((char*)"\r\n\0");
+            while (printcRoom() < CMD_PRINTC_MAX) {task_wait(1);}
+            textTermLine(parseBuf, charCont);
             //------------------------------------------------------------
             // The string is consumed. Need to be cleared.
             //------------------------------------------------------------
             charCont = 0;
-            //------------------------------------------------------------
-            // Display / output a fresh prompt to the user
-            //------------------------------------------------------------
-            printa((char*)promptText);
         }
         //----------------------------------------------------------------
         // Support for ASCII 0x08 "BS" backspace and 'DEL'       28FEb2020
@@ -434,7 +716,11 @@ void __section("textTerm") textTerminal_task(void)
     task_close(); //--------- control will never fall onto this point
 }
 
-#undef PRINTA_BUFFER_SIZE
+#undef N_COMMANDS
+#undef CMD_NAME_SIZE
+#undef CMD_PRINTC_MAX
+#undef TXFLASH_SIZE
+#undef TXRING_SIZE
 #undef PARSE_BUFFER_SIZE
 
 //----------------------------------------------------------------- end of file
@@ -16,8 +16,19 @@ extern "C" {
 
 #include "stdbool.h"
     
-bool printa(char* constantStringStartAddress);
-void print_task(void);
+#include "stdint.h"
+    
+bool printa(char* ramString);
+bool printb(uint8_t byte);
+bool printn(const uint8_t* bytes, uint8_t n);
+bool printc(const char* constantStringStartAddress);
+bool printu(uint32_t value, uint8_t format, uint8_t width);
+uint8_t printRoom(void);
+uint8_t printcRoom(void);
+void textTermTx_ISR(void);
+uint8_t textTermTxPull(uint8_t* bytes, uint8_t max);
+bool textTermTxIdle(void);
+void textTermLine(char* line, uint8_t n);
 void textTerminal_task(void);
 
 #ifdef	__cplusplus
@@ -0,0 +1,168 @@
+/*-----------------------------------------------------------------------------
+ * File:   fmtbench.c
+ *
+ * Host check and benchmark of the decimal conversion in u32Fmt() (i2a.c)
+ * against the digit loop of the former u32Toa11_task(), which took one
+ * x % 10 and one x /= 10 per digit. Run from the project root:
+ *
+ *   gcc -O2 -D'__section(s)=' -DOS_HOST -I. -Icocoos/inc \
+ *       tools/fmtbench.c i2a.c -o /tmp/fb && /tmp/fb
+ *
+ * Check: CHECKS random values, log-uniform over the digit count so that
+ * short numbers are as well covered as 10 digit ones, plus the edges
+ * around each power of ten, in FMT_DEC, FMT_FIX(1..9) with widths and
+ * FMT_HEX(1..4), all compared with the C library printf(). The old loop is
+ * compared too. Any mismatch is printed and fails the run.
+ *
+ * Benchmark: per value, the operations each method needs, counted from its
+ * result, and the host time. The old loop is two 32-bit divisions per
+ * digit; the PIC18 has no divide instruction, each is a library call of
+ * 32 shift-subtract steps. u32Fmt() needs one 32-bit compare and subtract
+ * per unit of each digit, at most 9, and no division. Host timings only
+ * show the ratio on a machine with a hardware divider, which understates
+ * it: the operation counts are the figure that carries over to the PIC18.
+ * They are turned into PIC18 cycles with the cost per operation below, an
+ * estimate from the instruction count of each loop, not a measurement.
+ *---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "i2a.h"
+
+#define CHECKS     (5000000UL)
+#define BENCH      (1000000UL)
+#define REPEAT     (20)
+#define PIC_DIV    (450)    // cycles, 32-bit library division, 32 x ~14
+#define PIC_STEP   (24)     // cycles, pow10L[] table read, compare, subtract
+
+static double nowNs(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* The former u32Toa11_task() loop, without its task_wait(1) per digit */
+static void oldU32Toa11(uint32_t x, char s[11])
+{
+    uint8_t i = 11;
+    s[--i] = '\0';
+    do {
+        s[--i] = '0' + (uint8_t)(x % 10);
+        x /= 10;
+    }
+    while (x);
+    while (i) { s[--i] = ' '; }
+}
+
+static uint32_t randU32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+/* Log-uniform: a random digit count first, then a value of that length */
+static uint32_t randValue(void)
+{
+    uint32_t x = randU32();
+    unsigned bits = (unsigned)(rand() % 33);
+    return bits ? x >> (32 - bits) : 0;
+}
+
+static unsigned long bad = 0;
+
+static void expect(const char *what, uint32_t x, uint8_t f, uint8_t w,
+                   const char *got, const char *ref)
+{
+    if (strcmp(got, ref) == 0) {return;}
+    if (bad < 10) {
+        printf("%s x %lu f 0x%02X w %u: \"%s\", expected \"%s\"\n", what,
+               (unsigned long)x, f, w, got, ref);
+    }
+    ++bad;
+}
+
+static void check(uint32_t x)
+{
+    char got[32], ref[32];
+    uint8_t f, w, n;
+    uint32_t p;
+
+    oldU32Toa11(x, got);
+    sprintf(ref, "%10lu", (unsigned long)x);
+    expect("old", x, FMT_DEC, 10, got, ref);
+
+    for (w = 0; w <= 12; w += 6) {
+        n = u32FmtLen(x, FMT_DEC, w);
+        u32Fmt(x, FMT_DEC, w, got, 0, 0xFF);
+        got[n] = '\0';
+        sprintf(ref, "%*lu", w, (unsigned long)x);
+        expect("dec", x, FMT_DEC, w, got, ref);
+    }
+    for (f = 1, p = 10; f <= 9; ++f, p *= 10) {
+        w = (uint8_t)((x & 1) ? 12 : 0);
+        n = u32FmtLen(x, FMT_FIX(f), w);
+        u32Fmt(x, FMT_FIX(f), w, got, 0, 0xFF);
+        got[n] = '\0';
+        sprintf(ref, "%*lu.%0*lu", w > f + 1 ? w - f - 1 : 0,
+                (unsigned long)(x / p), f, (unsigned long)(x % p));
+        expect("fix", x, FMT_FIX(f), w, got, ref);
+    }
+    for (f = 1; f <= 4; ++f) {
+        n = u32FmtLen(x, FMT_HEX(f), 0);
+        u32Fmt(x, FMT_HEX(f), 0, got, 0, 0xFF);
+        got[n] = '\0';
+        sprintf(ref, "0x%0*lX", 2 * f,
+                (unsigned long)(f < 4 ? x & ((1UL << (8 * f)) - 1) : x));
+        expect("hex", x, FMT_HEX(f), 0, got, ref);
+    }
+}
+
+int main(void)
+{
+    static uint32_t v[BENCH];
+    static char s[16];
+    char t[11];
+    unsigned long i, digits = 0, units = 0;
+    uint32_t p;
+    unsigned r;
+    double ns, nsOld = 0, nsNew = 0;
+    volatile char sink = 0;
+
+    srand(1);
+    check(0);
+    check(0xFFFFFFFFUL);
+    for (p = 10; p <= 1000000000UL; p *= 10) {check(p - 1); check(p); check(p + 1);}
+    for (i = 0; i != CHECKS; ++i) {check(randValue());}
+    printf("check: %lu values, %lu mismatches\n", CHECKS + 30, bad);
+
+    /* Operation counts over the benchmark set, taken from the digits */
+    for (i = 0; i != BENCH; ++i) {
+        v[i] = randValue();
+        u32Fmt(v[i], FMT_DEC, 0, s, 0, 0xFF);
+        uint8_t n = u32FmtLen(v[i], FMT_DEC, 0), k;
+        digits += n;
+        for (k = 0; k + 1 < n; ++k) {units += (unsigned long)(s[k] - '0');}
+    }
+    printf("old loop : %5.2f digits, %5.2f 32-bit divisions per value\n",
+           (double)digits / BENCH, 2.0 * digits / BENCH);
+    printf("u32Fmt() : %5.2f 32-bit subtractions, %5.2f compares, "
+           "0 divisions per value\n", (double)units / BENCH,
+           (double)(units + digits - BENCH) / BENCH);
+    printf("PIC18    : old loop ~%4.0f cycles, u32Fmt() ~%4.0f cycles per value"
+           " (estimate)\n", 2.0 * PIC_DIV * digits / BENCH,
+           (double)PIC_STEP * (units + digits - BENCH) / BENCH);
+
+    for (r = 0; r != REPEAT; ++r) {
+        ns = nowNs();
+        for (i = 0; i != BENCH; ++i) {oldU32Toa11(v[i], t); sink ^= t[9];}
+        nsOld += nowNs() - ns;
+        ns = nowNs();
+        for (i = 0; i != BENCH; ++i) {u32Fmt(v[i], FMT_DEC, 10, s, 0, 0xFF); sink ^= s[9];}
+        nsNew += nowNs() - ns;
+    }
+    printf("host     : old loop %5.1f ns, u32Fmt() %5.1f ns per value\n",
+           nsOld / ((double)REPEAT * BENCH), nsNew / ((double)REPEAT * BENCH));
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+#------------------------------------------------------------------------------
+# File:   linkclient.py
+#
+# Host client for the framed console link (see link.h). Enters link mode from
+# the text console, optionally raises the baud rate, runs console commands
+# and prints their replies.
+#
+#   python3 linkclient.py --port /dev/ttyUSB0 sysi cmps
+#   python3 linkclient.py --port /dev/ttyUSB0 --rate 115200 pod1 --listen 10
+#
+# Each reply ends with the ">" prompt. Output sent by the device without a
+# command (e.g. "pod1" reports) is printed as it arrives while --listen runs.
+# Needs pyserial.
+#------------------------------------------------------------------------------
+
+import argparse
+import sys
+import time
+
+MTU = 32
+DATA, ACK, NAK, CTRL = 0x00, 0x10, 0x20, 0x30
+CTRL_EXIT, CTRL_BAUD = 0, 1
+BAUDS = [38400, 57600, 115200, 230400, 460800]
+ACK_S = 0.3
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        x = ((crc >> 8) ^ b) & 0xFF
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out, block = bytearray(), bytearray()
+    for b in data:
+        if b:
+            block.append(b)
+        else:
+            out += bytes([len(block) + 1]) + block
+            block = bytearray()
+    out += bytes([len(block) + 1]) + block
+    return bytes(out) + b"\x00"
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Link:
+    def __init__(self, port):
+        self.port = port
+        self.buf = bytearray()
+        self.rx_expect = 0      # next device seq
+        self.tx_seq = 0         # next host seq
+        self.text = bytearray()
+
+    def frame(self, ctl, data=b""):
+        raw = bytes([ctl]) + data
+        c = crc16(raw)
+        self.port.write(cobs_encode(raw + bytes([c & 0xFF, c >> 8])))
+
+    def poll(self):
+        # Read what is there, deliver in-sequence console text, answer with
+        # ACK / NAK. Returns the (type, seq) of ACK / NAK frames received.
+        acks = []
+        self.buf += self.port.read(max(1, self.port.in_waiting))
+        while True:
+            n = self.buf.find(b"\x00")
+            if n < 0:
+                return acks
+            enc, self.buf = bytes(self.buf[:n]), self.buf[n + 1:]
+            if not enc:
+                continue
+            p = cobs_decode(enc)
+            if p is None or len(p) < 3 or crc16(p[:-2]) != p[-2] | p[-1] << 8:
+                self.frame(NAK | self.rx_expect)
+                continue
+            t, s = p[0] & 0xF0, p[0] & 0x07
+            if t in (ACK, NAK):
+                acks.append((t, s))
+            elif t == DATA:
+                if s == self.rx_expect:
+                    self.text += p[1:-2]
+                    self.rx_expect = (self.rx_expect + 1) & 7
+                self.frame(ACK | self.rx_expect)
+
+    def send(self, ctl, data=b""):
+        # One sequenced frame, repeated until acknowledged.
+        seq = self.tx_seq
+        self.tx_seq = (seq + 1) & 7
+        for _ in range(10):
+            self.frame(ctl | seq, data)
+            t0 = time.monotonic()
+            while time.monotonic() - t0 < ACK_S:
+                r = self.poll()
+                if any(s == self.tx_seq for t, s in r):
+                    return
+                if any(t == NAK for t, s in r):
+                    break
+        raise IOError("no ACK from device")
+
+    def command(self, line, timeout=2.0):
+        if len(line) > MTU:
+            raise ValueError("command longer than %d characters" % MTU)
+        self.text = bytearray()
+        self.send(DATA, line.encode("ascii"))
+        t0 = time.monotonic()
+        while not self.text.endswith(b">"):
+            if time.monotonic() - t0 > timeout:
+                break
+            self.poll()
+        return self.text.decode("ascii", "replace")
+
+    def baud(self, rate):
+        self.send(CTRL, bytes([CTRL_BAUD, BAUDS.index(rate)]))
+        time.sleep(0.01)
+        self.port.baudrate = rate
+        self.frame(ACK | self.rx_expect)    # confirms the new rate
+
+    def exit(self):
+        # The device is back in text mode as soon as its ACK has gone out,
+        # a lost ACK does not change that.
+        try:
+            self.send(CTRL, bytes([CTRL_EXIT]))
+        except IOError:
+            pass
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("commands", nargs="*")
+    ap.add_argument("--port", required=True)
+    ap.add_argument("--rate", type=int, choices=BAUDS, default=38400)
+    ap.add_argument("--listen", type=float, default=0, help="seconds")
+    a = ap.parse_args()
+
+    import serial
+    port = serial.Serial(a.port, 38400, timeout=0.01)
+    port.write(b"\rlink\r")
+    port.read_until(b"follows this prompt.\r\n\r\n>")
+    link = Link(port)
+    if a.rate != 38400:
+        link.baud(a.rate)
+    for c in a.commands:
+        sys.stdout.write(link.command(c))
+    t0 = t1 = time.monotonic()
+    while time.monotonic() - t0 < a.listen:
+        link.text = bytearray()
+        link.poll()
+        if time.monotonic() - t1 > 5.0:
+            link.frame(ACK | link.rx_expect)    # keep-alive
+            t1 = time.monotonic()
+        sys.stdout.write(link.text.decode("ascii", "replace"))
+    link.exit()
+    print()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,325 @@
+/*-----------------------------------------------------------------------------
+ * File:   parsebench.c
+ *
+ * Host benchmark of the console command parser: the former switch (j-i)
+ * parser of textTerminal_task() against commandDispatch() and its flash
+ * table commandTable[] (textTerm.c). Run from the project root:
+ *
+ *   gcc -O2 -D'__section(s)=' -DOS_HOST -I. -Icocoos/inc \
+ *       tools/parsebench.c i2a.c -o /tmp/pb && /tmp/pb
+ *
+ * textTerm.c needs the MCU headers, so both parsers are copied here with
+ * every handler replaced by a record of the command and its value. Keep
+ * the copy of commandTable[] and commandDispatch() in step with textTerm.c.
+ * Values are parsed by the real hexStringtoi32() / decStringtoi32().
+ *
+ * Both parsers are first checked to pick the same command and value for
+ * every line of lines[] and for FUZZ random lines built from command name
+ * characters. Then, per line, the characters each parser reads and its host
+ * time are reported. The character reads carry over to the PIC18, where
+ * each costs a few instructions; the host time gives the ratio only.
+ *---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "i2a.h"
+
+#define FUZZ       (2000000UL)
+#define RUNS       (2000000UL)
+
+static double nowNs(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* Handler record: the command name run and its value or param, "!" for
+ * "Invalid Value" */
+static const char *hit;
+static uint32_t hitV;
+static unsigned long reads;
+
+static void run(const char *name, uint32_t v) {hit = name; hitV = v;}
+
+/*---------------------------------------------------------------------------
+ * Former parser, the line is parseBuf[i..j), trimmed. P(k) is a counted
+ * read of parseBuf[i+k]. The case 7 fall-through into default is kept.
+ *-------------------------------------------------------------------------*/
+#define P(k) (++reads, parseBuf[i+(k)])
+
+static bool oldValue(const char *parseBuf, uint8_t i, uint8_t j, uint32_t max,
+                     uint32_t *v)
+{
+    bool isValid = false;
+    if ((j-i)>7)
+    {
+        isValid = hexStringtoi32((char*)&parseBuf[i+7], j-i-7, v);
+        if (!isValid)
+            {isValid = decStringtoi32((char*)&parseBuf[i+7], j-i-7, v);}
+    }
+    if (!isValid || *v > max) {run("!", 0); return false;}
+    return true;
+}
+
+static bool oldParse(const char *parseBuf, uint8_t i, uint8_t j)
+{
+    bool isCommandValid = false;
+    uint32_t v;
+    switch (j-i)
+    {
+        case 0:
+            isCommandValid = true;
+            break;
+        case 1:
+            if (P(0) == '?') {run("?", 0); isCommandValid = true;}
+            break;
+        case 4:
+            if (P(0) == 'h' && P(1) == 'e' && P(2) == 'l' && P(3) == 'p')
+                {run("help", 0); isCommandValid = true;}
+            else if (P(0) == 'e' && P(1) == 'u' && P(2) == 'l' && P(3) == 'a')
+                {run("eula", 0); isCommandValid = true;}
+            else if (P(0) == 'c' && P(1) == 'm' && P(2) == 'p' && P(3) == 's')
+                {run("cmps", 0); isCommandValid = true;}
+            else if (P(0) == 's' && P(1) == 'y' && P(2) == 's' && P(3) == 'i')
+                {run("sysi", 0); isCommandValid = true;}
+            else if (P(0) == 'p' && P(1) == 'o' && P(2) == 'd')
+            {
+                switch (P(3))
+                {
+                    case '0': run("pod0", 0); isCommandValid = true; break;
+                    case '1': run("pod1", 1); isCommandValid = true; break;
+                    case '3': run("pod3", 3); isCommandValid = true; break;
+                    default: break;
+                }
+            }
+            break;
+        case 7:
+            if (P(0) == 'a' && P(1) == 'l' && P(2) == 'm' && P(3) == 's'
+             && P(4) == 'e' && P(5) == 't')
+            {
+                switch (P(6))
+                {
+                    case '0': run("almset0", 0); isCommandValid = true; break;
+                    case '1': run("almset1", 1); isCommandValid = true; break;
+                    case '2': run("almset2", 2); isCommandValid = true; break;
+                    default: break;
+                }
+            }
+        default:
+            if (P(0) == 'a' && P(1) == 'l' && P(2) == 'e' && P(3) == 'v'
+             && P(4) == 'e' && P(5) == 'l')
+            {
+                if ((P(6) != '1') && (P(6) != '2')) {break;}
+                isCommandValid = true;
+                if (!oldValue(parseBuf, i, j, 0xFFFFFF, &v)) {break;}
+                run((P(6) == '1') ? "alevel1" : "alevel2", v);
+            }
+            else if (P(0) == 'v' && P(1) == 'o' && P(2) == 'l' && P(3) == 't'
+                  && P(4) == 'h' && P(5) == 'r' && P(6) == 'e')
+            {
+                if (oldValue(parseBuf, i, j, UINT8_MAX, &v)) {run("volthre", v);}
+                isCommandValid = true;
+            }
+            else if (P(0) == 's' && P(1) == 'a' && P(2) == 'm' && P(3) == 'p'
+                  && P(4) == 'l' && P(5) == 'e' && P(6) == 'i')
+            {
+                if (oldValue(parseBuf, i, j, UINT8_MAX, &v)) {run("samplei", v);}
+                isCommandValid = true;
+            }
+            else if (P(0) == 'a' && P(1) == 'n' && P(2) == 'a'
+                  && ((P(3) == 'z' && P(4) == 'e' && P(5) == 'r' && P(6) == 'o')
+                   || (P(3) == 'f' && P(4) == 'u' && P(5) == 'l' && P(6) == 'l')))
+            {
+                if (oldValue(parseBuf, i, j, UINT16_MAX, &v))
+                    {run((P(3) == 'z') ? "anazero" : "anafull", v);}
+                isCommandValid = true;
+            }
+            break;
+    }
+    return isCommandValid;
+}
+#undef P
+
+/*---------------------------------------------------------------------------
+ * commandDispatch() and commandTable[] of textTerm.c. The handler is the
+ * name recorded, param as in the table. Reads of the line and of the names
+ * (strlen(), memcmp()) are counted.
+ *-------------------------------------------------------------------------*/
+#define CMD_NAME_SIZE (8)
+typedef struct
+{
+    char name[CMD_NAME_SIZE];
+    uint32_t argMax;
+    uint8_t param;
+}
+command_t;
+
+static const command_t commandTable[] =
+{
+    {"?",       0,          0},
+    {"help",    0,          0},
+    {"eula",    0,          0},
+    {"cmps",    0,          0},
+    {"sysi",    0,          0},
+    {"pod0",    0,          0},
+    {"pod1",    0,          1},
+    {"pod2",    100,        0},
+    {"pod3",    0,          3},
+    {"almset0", 0,          0},
+    {"almset1", 0,          1},
+    {"almset2", 0,          2},
+    {"alevel1", 0x00FFFFFF, 0},
+    {"alevel2", 0x00FFFFFF, 0},
+    {"volthre", UINT8_MAX,  0},
+    {"samplei", UINT8_MAX,  0},
+    {"anazero", UINT16_MAX, 0},
+    {"anafull", UINT16_MAX, 0},
+    {"prof",    3,          0},
+    {"wear",    0,          0},
+    {"time",    0,          0},
+    {"settime", INT32_MAX,  0},
+    {"oscal",   1000,       0},
+    {"link",    0,          0},
+};
+#define N_COMMANDS (sizeof(commandTable)/sizeof(commandTable[0]))
+
+static uint8_t countedStrlen(const char *s)
+{
+    uint8_t l = 0;
+    while (++reads, s[l]) {++l;}
+    return l;
+}
+
+static int countedMemcmp(const char *a, const char *b, uint8_t l)
+{
+    for (; l; --l, ++a, ++b) {
+        reads += 2;
+        if (*a != *b) {return 1;}
+    }
+    return 0;
+}
+
+static bool commandDispatch(char *a, uint8_t n)
+{
+    const command_t *c = commandTable;
+    for (uint8_t k = 0; k < N_COMMANDS; ++k, ++c)
+    {
+        reads += 2;
+        if (c->name[0] != a[0]) {continue;}
+        uint8_t l = countedStrlen(c->name);
+        if ((l > n) || (countedMemcmp(a, c->name, l) != 0)) {continue;}
+        if (!c->argMax)
+        {
+            if (l != n) {continue;}
+            run(c->name, c->param);
+            return true;
+        }
+
+        uint32_t v;
+        bool isValid = false;
+        if (n > l)
+        {
+            isValid = hexStringtoi32(&a[l], n-l, &v);
+            if (!isValid) {isValid = decStringtoi32(&a[l], n-l, &v);}
+        }
+        if (!isValid || v > c->argMax) {run("!", 0);}
+        else {run(c->name, v);}
+        return true;
+    }
+    return false;
+}
+
+/*-------------------------------------------------------------------------*/
+static const char *lines[] =
+{
+    "?", "help", "eula", "cmps", "sysi", "pod0", "pod1", "pod3",
+    "almset0", "almset1", "almset2", "alevel1 0x123456", "alevel2 100000",
+    "volthre 16", "samplei 0x32", "anazero 0", "anafull 1000",
+    "alevel1 0x1000000", "volthre", "helq", "pod9", "almset7", "xyz",
+};
+#define N_LINES (sizeof(lines)/sizeof(lines[0]))
+
+/* Lines that begin with a command the former parser did not have */
+static bool newOnly(const char *a)
+{
+    static const char *names[] =
+        {"pod2", "prof", "wear", "time", "settime", "oscal", "link"};
+    for (unsigned k = 0; k != sizeof(names)/sizeof(names[0]); ++k) {
+        if (!strncmp(a, names[k], strlen(names[k]))) {return true;}
+    }
+    return false;
+}
+
+static bool same(char *a, uint8_t n)
+{
+    const char *h;
+    uint32_t v;
+    bool r;
+
+    if (newOnly(a)) {return true;}
+    hit = NULL;
+    r = oldParse(a, 0, n);
+    h = hit; v = hitV;
+    hit = NULL;
+    if (commandDispatch(a, n) != r) {return false;}
+    if ((h == NULL) != (hit == NULL)) {return false;}
+    return (h == NULL) || (!strcmp(h, hit) && v == hitV);
+}
+
+int main(void)
+{
+    static const char fuzzChars[] = "?acdefhilmnoprstuvyz0123456789x ";
+    char b[32];
+    unsigned long i, bad = 0, oldReads, newReads;
+    uint8_t k, n;
+    double t, nsOld, nsNew, sumOld = 0, sumNew = 0;
+    volatile bool sink = false;
+
+    srand(1);
+    for (i = 0; i != N_LINES + FUZZ; ++i) {
+        if (i < N_LINES) {
+            n = (uint8_t)strlen(lines[i]);
+            memcpy(b, lines[i], n);
+        } else {
+            const char *s = lines[rand() % N_LINES];
+            n = (uint8_t)strlen(s);
+            memcpy(b, s, n);
+            for (k = (uint8_t)(rand() % 3); k; --k) {
+                b[rand() % n] = fuzzChars[rand() % (sizeof(fuzzChars) - 1)];
+            }
+            if (rand() & 1) {n = (uint8_t)(1 + rand() % n);}
+            while (n > 1 && b[n-1] == ' ') {--n;}
+            if (b[0] == ' ') {b[0] = 'a';}
+        }
+        b[n] = '\0';
+        if (!same(b, n)) {
+            if (bad < 10) {printf("differ: \"%s\"\n", b);}
+            ++bad;
+        }
+    }
+    printf("check: %lu lines, %lu differ\n\n", N_LINES + FUZZ, bad);
+
+    printf("%-18s  %5s %5s   %7s %7s\n", "line", "old", "new", "old", "new");
+    printf("%-18s  %11s   %15s\n", "", "char reads", "ns per line");
+    for (i = 0; i != N_LINES; ++i) {
+        n = (uint8_t)strlen(lines[i]);
+        memcpy(b, lines[i], n + 1);
+        reads = 0; oldParse(b, 0, n); oldReads = reads;
+        reads = 0; commandDispatch(b, n); newReads = reads;
+        t = nowNs();
+        for (unsigned long r = 0; r != RUNS; ++r) {sink ^= oldParse(b, 0, n);}
+        nsOld = (nowNs() - t) / RUNS;
+        t = nowNs();
+        for (unsigned long r = 0; r != RUNS; ++r) {sink ^= commandDispatch(b, n);}
+        nsNew = (nowNs() - t) / RUNS;
+        sumOld += nsOld; sumNew += nsNew;
+        printf("%-18s  %5lu %5lu   %7.1f %7.1f\n", lines[i], oldReads, newReads,
+               nsOld, nsNew);
+    }
+    printf("%-18s  %11s   %7.1f %7.1f\n", "mean", "", sumOld / N_LINES,
+           sumNew / N_LINES);
+    return bad ? 1 : 0;
+}
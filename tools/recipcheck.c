@@ -0,0 +1,78 @@
+/*-----------------------------------------------------------------------------
+ * File:   recipcheck.c
+ *
+ * Host check of recipDiv() (recip.c) against the C division, for the bound
+ * documented in recip.h: recipDiv(n, t) == n / t for n < 2^31, 0 < t < 2^24.
+ * Run from the project root:
+ *
+ *   gcc -O2 -D'__section(s)=' -I. tools/recipcheck.c recip.c -o /tmp/rc &&
+ *   /tmp/rc
+ *
+ * Every t from 1 to 2^24 - 1 is checked with each n of nList[]: the largest
+ * n, the numerator of recipPeriodHz100(), and values where n / t is large
+ * or has few bits. Then RANDOM_N random n, each with every t. The seed table
+ * is checked against its formula. The PIC18 int is 16 bits, the host's 32;
+ * recip.c casts every product it needs wide, so the arithmetic is the same.
+ *---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "recip.h"
+
+#define T_END      (1UL << 24)
+#define RANDOM_N   (16)
+
+static const uint32_t nList[] =
+{
+    0x7FFFFFFFUL,               // n < 2^31
+    100 * RECIP_TICK_HZ,        // recipPeriodHz100()
+    1000000000UL,
+    0x40000000UL,
+    0x00FFFFFFUL,
+    1, 0
+};
+
+static unsigned long checkN(uint32_t n)
+{
+    uint32_t t;
+    unsigned long bad = 0;
+    for (t = 1; t != T_END; ++t) {
+        if (recipDiv(n, t) != n / t) {
+            if (!bad) {
+                printf("n %lu t %lu: %lu, expected %lu\n", (unsigned long)n,
+                       (unsigned long)t, (unsigned long)recipDiv(n, t),
+                       (unsigned long)(n / t));
+            }
+            ++bad;
+        }
+    }
+    return bad;
+}
+
+int main(void)
+{
+    unsigned long bad = 0;
+    uint32_t n;
+    unsigned i;
+
+    for (i = 0; i != 128; ++i) {
+        if (recipSeed[i] != (uint16_t)((8388608.0 / (128 + i + 0.5)) + 0.5)) {
+            printf("recipSeed[%u] %u\n", i, recipSeed[i]);
+            ++bad;
+        }
+    }
+    if (recipDiv(1, 0) != UINT32_MAX) {printf("t == 0\n"); ++bad;}
+
+    for (i = 0; i != sizeof(nList) / sizeof(nList[0]); ++i) {
+        bad += checkN(nList[i]);
+    }
+    srand(1);
+    for (i = 0; i != RANDOM_N; ++i) {
+        n = (((uint32_t)rand() << 16) ^ (uint32_t)rand()) & 0x7FFFFFFFUL;
+        bad += checkN(n);
+    }
+
+    printf("%lu t x %u n: %lu wrong\n", T_END - 1,
+           (unsigned)(sizeof(nList) / sizeof(nList[0]) + RANDOM_N), bad);
+    return bad != 0;
+}
@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------------------------
+ * File:   tickbench.c
+ *
+ * Host benchmark of the cocoOS main clock tick, i.e. the time taken by
+ * os_task_tick(0, 1) with every task waiting in task_wait(), scanning all
+ * tasks (OS_TIMER_LIST 0) or with the timer list (1). N_TASKS is compile
+ * time, run it once per configuration from the project root:
+ *
+ *   for n in 7 30; do for l in 0 1; do
+ *     gcc -O2 -DOS_HOST -DN_TASKS=$n -DOS_TIMER_LIST=$l \
+ *         -Icocoos/inc tools/tickbench.c cocoos/src/os_*.c -o /tmp/tb &&
+ *     /tmp/tb
+ *   done; done
+ *
+ * Each task waits a random 1..WAIT_MAX ticks and is made to wait again as
+ * soon as it wakes, so that all tasks are waiting on every tick. The tasks
+ * woken by each tick are checked against their deadlines. Only the tick is
+ * timed, the cost of starting a wait is reported separately. The overhead
+ * of reading the clock is measured first and taken off both.
+ *---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "cocoos.h"
+
+#define TICKS      (1000000UL)
+#define WAIT_MAX   (100)
+
+static void taskProc(void) {}
+
+static double nowNs(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(void)
+{
+    uint32_t due[N_TASKS];
+    uint32_t now, tick;
+    uint32_t woken = 0;
+    uint8_t i;
+    double t0, ovh = 0, tickNs = 0, waitNs = 0;
+
+    for (tick = 0; tick != TICKS; ++tick) {
+        t0 = nowNs();
+        ovh += nowNs() - t0;
+    }
+    ovh /= TICKS;
+
+    srand(1);
+    os_init();
+    for (i = 0; i != N_TASKS; ++i) {task_create(taskProc, NULL, i + 1, NULL, 0, 0);}
+
+    now = 0;
+    for (i = 0; i != N_TASKS; ++i) {
+        due[i] = now + 1 + rand() % WAIT_MAX;
+        os_task_wait_time_set(i, 0, due[i] - now);
+    }
+
+    for (tick = 0; tick != TICKS; ++tick) {
+        t0 = nowNs();
+        os_task_tick(0, 1);
+        tickNs += nowNs() - t0 - ovh;
+        ++now;
+
+        for (i = 0; i != N_TASKS; ++i) {
+            if ((task_state_get(i) == READY) != (due[i] == now)) {
+                printf("mismatch: task %u tick %lu\n", i, (unsigned long)now);
+                return 1;
+            }
+            if (due[i] == now) {
+                ++woken;
+                due[i] = now + 1 + rand() % WAIT_MAX;
+                t0 = nowNs();
+                os_task_wait_time_set(i, 0, due[i] - now);
+                waitNs += nowNs() - t0 - ovh;
+            }
+        }
+    }
+
+    printf("N_TASKS %2d  %s  %6.1f ns/tick  %6.1f ns/wait  %.2f wake-ups/tick\n",
+           N_TASKS, OS_TIMER_LIST ? "list" : "scan", tickNs / TICKS,
+           waitNs / woken, (double)woken / TICKS);
+    return 0;
+}
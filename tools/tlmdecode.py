@@ -0,0 +1,95 @@
+#------------------------------------------------------------------------------
+# File:   tlmdecode.py
+#
+# Host decoder for the "pod3" binary telemetry stream (see telemetry.h). Reads
+# a captured byte stream from a file, stdin or a serial port, splits on the
+# 0x00 delimiter, COBS-decodes, checks CRC-16/CCITT-FALSE and writes CSV.
+#
+#   python3 tlmdecode.py capture.bin > drive.csv
+#   python3 tlmdecode.py --port /dev/ttyUSB0 --baud 38400 > drive.csv
+#
+# Frames failing COBS or CRC (e.g. console text interleaved with the stream)
+# are counted and reported on stderr at the end. Serial input needs pyserial.
+#------------------------------------------------------------------------------
+
+import argparse
+import sys
+
+GEAR = {0: "sparse", 1: "continuous", 2: "single"}
+F_LOST, F_FIRST, F_TRIP = 0x04, 0x08, 0x10
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        x = ((crc >> 8) ^ b) & 0xFF
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def records(chunks):
+    buf = bytearray()
+    for chunk in chunks:
+        buf += chunk
+        while True:
+            n = buf.find(b"\x00")
+            if n < 0:
+                break
+            frame, buf = bytes(buf[:n]), buf[n + 1:]
+            yield frame
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("file", nargs="?", help="capture file, default stdin")
+    ap.add_argument("--port", help="serial port to read instead of a file")
+    ap.add_argument("--baud", type=int, default=38400)
+    a = ap.parse_args()
+
+    if a.port:
+        import serial
+        src = serial.Serial(a.port, a.baud, timeout=1)
+        chunks = iter(lambda: src.read(256), None)
+    else:
+        src = open(a.file, "rb") if a.file else sys.stdin.buffer
+        chunks = iter(lambda: src.read(4096), b"")
+
+    bad = 0
+    print("seq,gear,period_raw,period_us,freq_hz,lost,first,trip")
+    try:
+        for frame in records(chunks):
+            p = cobs_decode(frame) if frame else None
+            if p is None or len(p) != 7 or crc16(p[:5]) != p[5] | p[6] << 8:
+                bad += 1
+                continue
+            seq, flags = p[0], p[1]
+            raw = p[2] | p[3] << 8 | p[4] << 16
+            gear = flags & 0x03
+            us = raw * 25000.0 if gear == 0 else raw / 16.0
+            hz = 1e6 / us if us else 0.0
+            print("%d,%s,%d,%.3f,%.3f,%d,%d,%d" % (
+                seq, GEAR.get(gear, "?"), raw, us, hz,
+                bool(flags & F_LOST), bool(flags & F_FIRST),
+                bool(flags & F_TRIP)))
+    except KeyboardInterrupt:
+        pass
+    print("frames rejected: %d" % bad, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()